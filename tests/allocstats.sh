@@ -0,0 +1,32 @@
+#!/bin/sh
+# Checks that --alloc-stats attributes allocations to every compiler phase and
+# to the token category, and that the counts for a fixed input do not change
+# between runs.
+# Usage: allocstats.sh <ymp> <work-dir>
+ymp=$1
+work=$2
+mkdir -p "$work"
+printf 'char greeting(){\nchar salutation, addressee;\nint counter;\nsalutation = "a rather long greeting literal" + "and another long literal";\naddressee = salutation + salutation;\ncounter = 1 + 2;\nreturn addressee;\n}\n' > "$work/input.txt"
+
+status=0
+for run in 1 2; do
+    if ! "$ymp" -i "$work/input.txt" -o "$work/stats$run.out" --alloc-stats --emit-c "$work/input.c"; then
+        echo "ymp --alloc-stats failed"
+        exit 1
+    fi
+    sed -n '/^=== ALLOCATIONS ===$/,$p' "$work/stats$run.out" | cut -c1-27 > "$work/counts$run.txt"
+done
+
+for row in lexer parser semantic ir emit codegen tokens; do
+    count=$(grep -m 1 "^$row " "$work/counts1.txt" | cut -c15-27 | tr -d ' ')
+    if [ -z "$count" ] || [ "$count" -eq 0 ]; then
+        echo "no allocations counted for '$row'"
+        status=1
+    fi
+done
+if ! cmp -s "$work/counts1.txt" "$work/counts2.txt"; then
+    echo "allocation counts differ between runs:"
+    diff "$work/counts1.txt" "$work/counts2.txt"
+    status=1
+fi
+exit $status
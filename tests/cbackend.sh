@@ -0,0 +1,31 @@
+#!/bin/sh
+# Compiles each program with --emit-c, builds it with the system C compiler and
+# compares the printed result with the postfix semantics executed at -O0.
+# Usage: cbackend.sh <ymp> <programs-dir> <work-dir>
+ymp=$1
+programs=$2
+work=$3
+CC=${CC:-cc}
+mkdir -p "$work"
+
+status=0
+for program in "$programs"/*.txt; do
+    name=$(basename "$program" .txt)
+    if ! "$ymp" -O0 -i "$program" -o "$work/$name.out" --emit-c "$work/$name.c" --profile "$work/$name.prof"; then
+        echo "$name: ymp failed"
+        status=1
+        continue
+    fi
+    if ! $CC -o "$work/$name" "$work/$name.c"; then
+        echo "$name: generated C does not compile"
+        status=1
+        continue
+    fi
+    expected=$(sed -n 's/^RESULT: //p' "$work/$name.prof" | sed 's/^"\(.*\)"$/\1/')
+    actual=$("$work/$name")
+    if [ "$expected" != "$actual" ]; then
+        echo "$name: expected '$expected', native code printed '$actual'"
+        status=1
+    fi
+done
+exit $status
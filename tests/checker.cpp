@@ -0,0 +1,63 @@
+#include "../ymp/compiler.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+static bool sameErrors(const char* name, const char* kind, const std::vector<std::string>& full, const std::vector<std::string>& checked) {
+    if (full == checked) {
+        return true;
+    }
+    std::printf("%s: %s errors differ\n", name, kind);
+    for (const std::string& error : full) {
+        std::printf("  full:       %s\n", error.c_str());
+    }
+    for (const std::string& error : checked) {
+        std::printf("  check-only: %s\n", error.c_str());
+    }
+    return false;
+}
+
+// --check-only must report exactly what the full pipeline reports, with and
+// without cascade suppression, so the fast path can stand in for a compile.
+static bool checkFile(const std::filesystem::path& path, Compiler& full, Compiler& checker) {
+    std::ifstream file(path);
+    std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::string name = path.filename().string();
+    bool ok = true;
+    for (bool allErrors : { false, true }) {
+        CompileOptions options;
+        options.allErrors = allErrors;
+        const CompileResult& fullResult = full.compile(source, options);
+        options.checkOnly = true;
+        const CompileResult& checkResult = checker.compile(source, options);
+        if (fullResult.success != checkResult.success) {
+            std::printf("%s: full compile %s, --check-only %s\n", name.c_str(),
+                fullResult.success ? "succeeds" : "fails", checkResult.success ? "succeeds" : "fails");
+            ok = false;
+        }
+        ok = sameErrors(name.c_str(), "syntax", fullResult.syntaxErrors, checkResult.syntaxErrors) && ok;
+        ok = sameErrors(name.c_str(), "semantic", fullResult.semanticErrors, checkResult.semanticErrors) && ok;
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("usage: checker <programs-dir>...\n");
+        return 2;
+    }
+    Compiler full;
+    Compiler checker;
+    bool ok = true;
+    size_t files = 0;
+    for (int i = 1; i < argc; i++) {
+        for (const auto& entry : std::filesystem::directory_iterator(argv[i])) {
+            ok = checkFile(entry.path(), full, checker) && ok;
+            files++;
+        }
+    }
+    return ok && files != 0 ? 0 : 1;
+}
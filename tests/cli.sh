@@ -0,0 +1,129 @@
+#!/bin/sh
+# Checks that malformed option values and unwritable outputs are reported.
+# Usage: cli.sh <ymp> <work-dir>
+ymp=$1
+work=$2
+mkdir -p "$work"
+printf 'int f(){\nint a;\na = 1;\nreturn a;\n}\n' > "$work/input.txt"
+
+status=0
+expect() {
+    code=$1
+    shift
+    "$ymp" "$@" -i "$work/input.txt" -o "$work/output.txt" 2>/dev/null
+    actual=$?
+    if [ "$actual" -ne "$code" ]; then
+        echo "ymp $*: expected exit code $code, got $actual"
+        status=1
+    fi
+}
+
+expect 2 --max-errors abc
+expect 2 --max-errors -1
+expect 2 --max-errors 99999999999999999999999
+expect 2 -j 4x
+expect 2 --profile-runs ""
+expect 2 --budget-ns-per-byte 1.5
+expect 2 --budget-allocs-per-byte x
+expect 2 --budget-bytes-per-byte 1e9
+expect 0 --max-errors 3 -j 2 --profile-runs 1
+
+expectSource() {
+    code=$1
+    source=$2
+    shift 2
+    printf "$source" > "$work/source.txt"
+    "$ymp" "$@" -i "$work/source.txt" -o "$work/output.txt" 2>/dev/null
+    actual=$?
+    if [ "$actual" -ne "$code" ]; then
+        echo "ymp $* on '$source': expected exit code $code, got $actual"
+        status=1
+    fi
+}
+
+expectSource 1 'int f(){\nint a;\na = 1 + ;\nreturn a;\n}\n'
+expectSource 1 'int f(){\nint a;\na = 1 + ;\nreturn a;\n}\n' --check-only
+expectSource 1 'int f(){\nchar s;\ns = 1;\nreturn s;\n}\n'
+expectSource 1 'int f(){\nchar s;\ns = 1;\nreturn s;\n}\n' --check-only
+expectSource 1 'int f(){\nint a;\na = zz + 1;\nreturn a;\n}\n' --emit-c "$work/zz.c"
+expectSource 0 'int f(){\nint a;\na = 1;\nreturn a;\n}\n' --emit-c "$work/ok.c"
+
+printf 'int f(){\nint a;\na = 1 + ;\na = 2 + ;\na = 3 + ;\nreturn a;\n}\n' > "$work/errors.txt"
+printf 'SYNTAX ERRORS:\nSyntax error at line 3, position 9: Expected identifier, constant or '"'('"' in numeric expression\ntoo many errors, stopping\n' > "$work/errors.expected"
+for mode in "" --check-only; do
+    "$ymp" $mode --max-errors 1 -i "$work/errors.txt" -o "$work/errors.out"
+    if ! cmp -s "$work/errors.expected" "$work/errors.out"; then
+        echo "ymp $mode --max-errors 1: the first error is not reported before the stop note"
+        status=1
+    fi
+done
+
+printf 'int f(){\nint a, b, c;\na = b c;\nb = 1\nc = ;\nreturn a;\n}\n' > "$work/recovery.txt"
+printf 'SYNTAX ERRORS:\nSyntax error at line 3, position 7: Expected SEMICOLON but found '"'c'"'\nSyntax error at line 5, position 5: Expected identifier, constant or '"'('"' in numeric expression\n' > "$work/recovery.expected"
+for mode in "" --check-only; do
+    "$ymp" $mode -i "$work/recovery.txt" -o "$work/recovery.out"
+    if ! cmp -s "$work/recovery.expected" "$work/recovery.out"; then
+        echo "ymp $mode: recovery resumed at an identifier that does not start an assignment"
+        status=1
+    fi
+done
+
+awk 'BEGIN { print "int f(){"; print "int a;"; for (i = 0; i < 150; i++) print "a = 1 + ;"; print "return a;"; print "}" }' > "$work/many.txt"
+for mode in "" --check-only; do
+    "$ymp" $mode --max-errors 0 -i "$work/many.txt" -o "$work/many.out"
+    if [ "$(grep -c '^Syntax error' "$work/many.out")" -ne 150 ] || grep -q 'too many errors' "$work/many.out"; then
+        echo "ymp $mode --max-errors 0: not every error was reported"
+        status=1
+    fi
+    "$ymp" $mode -i "$work/many.txt" -o "$work/many.out"
+    if [ "$(grep -c '^Syntax error' "$work/many.out")" -ne 100 ]; then
+        echo "ymp $mode: the default limit is not 100 errors"
+        status=1
+    fi
+done
+
+# Expressions may be 10000 levels deep, counting either nested parentheses or
+# the operators of one chain; one level more is a syntax error in both modes.
+deepExpression() {
+    awk -v kind="$1" -v n="$2" 'BEGIN {
+        if (kind == "string") {
+            printf "char f(){\nchar s;\ns = \"x\""
+            for (i = 0; i < n; i++) printf " + \"x\""
+            printf ";\nreturn s;\n}\n"
+            exit
+        }
+        printf "int f(){\nint a;\na = "
+        if (kind == "parens") {
+            for (i = 0; i < n; i++) printf "("
+            printf "1"
+            for (i = 0; i < n; i++) printf ")"
+        }
+        else {
+            printf "1"
+            for (i = 0; i < n; i++) printf " - 1"
+        }
+        printf ";\nreturn a;\n}\n"
+    }' > "$work/deep.txt"
+}
+for kind in parens chain string; do
+    for mode in "" --check-only; do
+        deepExpression $kind 10000
+        if ! "$ymp" $mode -i "$work/deep.txt" -o "$work/deep.out"; then
+            echo "ymp $mode: a $kind expression 10000 levels deep was rejected"
+            status=1
+        fi
+        deepExpression $kind 10001
+        "$ymp" $mode -i "$work/deep.txt" -o "$work/deep.out"
+        if [ "$(grep -c 'Expression is nested more than 10000 levels deep' "$work/deep.out")" -ne 1 ] || [ "$(grep -c '^Syntax error' "$work/deep.out")" -ne 1 ]; then
+            echo "ymp $mode: a $kind expression 10001 levels deep was not reported exactly once"
+            status=1
+        fi
+    done
+done
+
+"$ymp" -i "$work/input.txt" -o "$work/missing/output.txt" 2>/dev/null
+if [ $? -ne 2 ]; then
+    echo "ymp: an unwritable output file was not reported"
+    status=1
+fi
+exit $status
@@ -0,0 +1,18 @@
+#!/bin/sh
+# Runs the pathological inputs through --complexity-check, with the parser and
+# with the --check-only checker, so a change that makes any phase superlinear
+# in time, allocations or peak memory fails the budget.
+# Usage: complexity.sh <ymp> <corpus-dir> <work-dir>
+ymp=$1
+corpus=$2
+work=$3
+mkdir -p "$work"
+
+status=0
+for mode in "" --check-only; do
+    if ! "$ymp" $mode --complexity-check "$corpus"/*.txt --slowest "$work" > "$work/report.txt"; then
+        grep "OVER BUDGET" "$work/report.txt"
+        status=1
+    fi
+done
+exit $status
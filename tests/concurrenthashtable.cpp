@@ -0,0 +1,201 @@
+#include "../ymp/concurrenthashtable.h"
+#include "../ymp/lexer.h"
+#include "../ymp/tokenindex.h"
+#include "../ymp/tokenstream.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const int KEY_COUNT = 20000;
+static const unsigned MAX_THREADS = 32;
+
+static std::string keyName(int key) {
+    std::string name;
+    for (int k = key + 1; k > 0; k /= 26) {
+        name += static_cast<char>('a' + k % 26);
+    }
+    return name;
+}
+
+static bool checkConcurrentInserts(unsigned threadCount) {
+    ConcurrentHashTable table;
+    std::vector<std::vector<int>> indices(threadCount, std::vector<int>(KEY_COUNT, -1));
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; t++) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < KEY_COUNT; i++) {
+                int key = static_cast<int>((i + t * 7919) % KEY_COUNT);
+                indices[t][key] = table.insert(Token(TokenType::ID, keyName(key)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (table.size() != KEY_COUNT) {
+        std::printf("%u threads: %d entries, expected %d\n", threadCount, table.size(), KEY_COUNT);
+        return false;
+    }
+    std::vector<int> owner(KEY_COUNT, -1);
+    for (int key = 0; key < KEY_COUNT; key++) {
+        int index = indices[0][key];
+        if (index < 0 || index >= KEY_COUNT || owner[index] != -1) {
+            std::printf("%u threads: index %d for key %d is out of range or shared\n", threadCount, index, key);
+            return false;
+        }
+        owner[index] = key;
+        for (unsigned t = 1; t < threadCount; t++) {
+            if (indices[t][key] != index) {
+                std::printf("%u threads: key %d has indices %d and %d\n", threadCount, key, index, indices[t][key]);
+                return false;
+            }
+        }
+        if (table.find(Token(TokenType::ID, keyName(key))) != index) {
+            std::printf("%u threads: find disagrees with insert for key %d\n", threadCount, key);
+            return false;
+        }
+    }
+    std::vector<Token> entries;
+    table.snapshot(entries);
+    for (int index = 0; index < KEY_COUNT; index++) {
+        if (entries[index].value != keyName(owner[index])) {
+            std::printf("%u threads: snapshot entry %d is '%s'\n", threadCount, index, entries[index].value.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// Readers look up keys that are already present while writers insert enough
+// new ones to grow every shard several times; find() must never miss.
+static bool checkFindDuringGrowth() {
+    const int PRESENT = 1000;
+    const unsigned READERS = 4;
+    const unsigned WRITERS = 4;
+    ConcurrentHashTable table;
+    std::vector<int> expected(PRESENT);
+    for (int key = 0; key < PRESENT; key++) {
+        expected[key] = table.insert(Token(TokenType::ID, keyName(key)));
+    }
+    std::atomic<unsigned> writersLeft(WRITERS);
+    std::atomic<bool> ok(true);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < WRITERS; t++) {
+        threads.emplace_back([&, t]() {
+            for (int key = PRESENT + static_cast<int>(t); key < KEY_COUNT * 4; key += WRITERS) {
+                table.insert(Token(TokenType::ID, keyName(key)));
+            }
+            writersLeft--;
+        });
+    }
+    for (unsigned t = 0; t < READERS; t++) {
+        threads.emplace_back([&, t]() {
+            do {
+                for (int key = static_cast<int>(t); key < PRESENT; key++) {
+                    if (table.find(Token(TokenType::ID, keyName(key))) != expected[key]) {
+                        ok = false;
+                    }
+                }
+            } while (writersLeft > 0 && ok);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (!ok) {
+        std::printf("find missed a present key while the table grew\n");
+        return false;
+    }
+    if (table.size() != KEY_COUNT * 4) {
+        std::printf("growth: %d entries, expected %d\n", table.size(), KEY_COUNT * 4);
+        return false;
+    }
+    return true;
+}
+
+static bool checkSharedExport() {
+    const char* sources[] = {
+        "int f(){\nint a, b;\na = b + 1;\nreturn a;\n}\n",
+        "char g(){\nchar s;\nint a;\ns = \"x\" + \"y\";\nreturn s;\n}\n",
+        "int h(){\nint a, c;\nc = a - 1 + a;\nreturn c;\n}\n"
+    };
+    const size_t count = sizeof(sources) / sizeof(sources[0]);
+    ConcurrentHashTable table;
+    std::vector<std::string> files(count);
+    std::atomic<bool> ok(true);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < count; i++) {
+        threads.emplace_back([&, i]() {
+            Lexer lexer(sources[i], std::strlen(sources[i]));
+            TokenIndexWriter writer;
+            for (const Token& token : lexTokens(lexer)) {
+                writer.add(token, table.insert(token));
+            }
+            if (!writer.finish(files[i])) {
+                ok = false;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::vector<Token> entries;
+    table.snapshot(entries);
+    TokenIndexWriter lexiconWriter;
+    for (size_t i = 0; i < entries.size(); i++) {
+        lexiconWriter.addLexeme(static_cast<int>(i), entries[i]);
+    }
+    std::string lexiconBytes;
+    if (!ok || !lexiconWriter.finish(lexiconBytes)) {
+        std::printf("shared export: writing failed\n");
+        return false;
+    }
+
+    std::vector<uint32_t> lexiconStorage(lexiconBytes.size() / 4 + 1);
+    std::memcpy(lexiconStorage.data(), lexiconBytes.data(), lexiconBytes.size());
+    TokenIndex lexicon;
+    if (!lexicon.attach(reinterpret_cast<const char*>(lexiconStorage.data()), lexiconBytes.size()) || lexicon.lexemeCount() != entries.size()) {
+        std::printf("shared export: lexicon does not load: %s\n", lexicon.error().c_str());
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        std::vector<uint32_t> storage(files[i].size() / 4 + 1);
+        std::memcpy(storage.data(), files[i].data(), files[i].size());
+        TokenIndex index;
+        if (!index.attach(reinterpret_cast<const char*>(storage.data()), files[i].size()) || !index.sharedLexemes()) {
+            std::printf("shared export: index %zu does not load: %s\n", i, index.error().c_str());
+            return false;
+        }
+        if (index.verify() || !index.verify(&lexicon)) {
+            std::printf("shared export: index %zu does not verify against the lexicon only\n", i);
+            return false;
+        }
+        Lexer lexer(sources[i], std::strlen(sources[i]));
+        uint32_t position = 0;
+        for (const Token& token : lexTokens(lexer)) {
+            const TokenRecord& record = index.token(position++);
+            if (lexicon.lexeme(record.lexeme()) != token.value || record.offset != static_cast<uint32_t>(token.offset)) {
+                std::printf("shared export: token %u of index %zu does not match the source\n", position - 1, i);
+                return false;
+            }
+        }
+        if (position != index.tokenCount()) {
+            std::printf("shared export: index %zu has %u tokens, expected %u\n", i, index.tokenCount(), position);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    for (unsigned threadCount = 1; threadCount <= MAX_THREADS; threadCount *= 2) {
+        if (!checkConcurrentInserts(threadCount)) {
+            return 1;
+        }
+    }
+    return checkFindDuringGrowth() && checkSharedExport() ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#include "../ymp/compiler.h"
+#include "../ymp/embedded.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+static_assert(embeddedProgram<"int main(){ int x; char y; x=8; y=\"kf\"; return x; }">.postfix()
+    == "\n=== POSTFIX NOTATION ===\nint x 2 decl\nchar y 2 decl\n8 x =\n\"kf\" y =\nx RETURN\n");
+
+static_assert(compileEmbedded("int main(){ int x; x = 1 + ; return x; }").diagnostic().error == EmbeddedError::EXPECTED_OPERAND);
+static_assert(compileEmbedded("int main(){ int x; x = 1 + ; return x; }").diagnostic().position == 28);
+static_assert(compileEmbedded("int f(){ char a; a = 1; return a; }").diagnostic().error == EmbeddedError::TYPE_MISMATCH);
+static_assert(compileEmbedded("int f(){ int a, a; return a; }").diagnostic().error == EmbeddedError::ALREADY_DECLARED);
+static_assert(compileEmbedded("int f(){ int a, a; return a; }").diagnostic().semantic);
+static_assert(compileEmbedded("int f(){ int a; a = zz + 1; return a; }").diagnostic().error == EmbeddedError::UNDECLARED_VARIABLE);
+static_assert(compileEmbedded("int f(){ int a; a = f + 1; return a; }").diagnostic().error == EmbeddedError::FUNCTION_OPERAND);
+
+static const size_t MAX_SOURCE = 16384;
+
+static bool checkDirectory(const char* path, Compiler& compiler, EmbeddedProgram<MAX_SOURCE>& program) {
+    CompileOptions options;
+    options.optimize = false;
+    bool ok = true;
+    for (const auto& entry : std::filesystem::directory_iterator(path)) {
+        std::ifstream file(entry.path());
+        std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (source.size() >= MAX_SOURCE) {
+            continue;
+        }
+        program = compileEmbedded<MAX_SOURCE>(source);
+        const CompileResult& result = compiler.compile(source, options);
+        std::string name = entry.path().filename().string();
+        if (program.ok() != result.success) {
+            std::printf("%s: embedded compiler says %s, runtime compiler says %s\n", name.c_str(),
+                program.ok() ? "ok" : "error", result.success ? "ok" : "error");
+            ok = false;
+            continue;
+        }
+        size_t postfix = result.output.find("\n=== POSTFIX NOTATION ===\n");
+        if (program.ok() && (postfix == std::string::npos || result.output.compare(postfix, std::string::npos, program.postfix()) != 0)) {
+            std::printf("%s: postfix differs from the -O0 output\n", name.c_str());
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("usage: embedded <programs-dir>...\n");
+        return 2;
+    }
+    Compiler compiler;
+    auto program = std::make_unique<EmbeddedProgram<MAX_SOURCE>>();
+    bool ok = true;
+    for (int i = 1; i < argc; i++) {
+        ok = checkDirectory(argv[i], compiler, *program) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,24 @@
+#!/bin/sh
+# Runs each input through a full compile and --check-only and compares the
+# output with the .expected file next to it: invalid UTF-8 must be reported
+# by line and byte offset, and valid non-ASCII text counted one column per
+# character.
+# Usage: encoding.sh <ymp> <inputs-dir> <work-dir>
+ymp=$1
+inputs=$2
+work=$3
+mkdir -p "$work"
+
+status=0
+for input in "$inputs"/*.txt; do
+    name=$(basename "$input" .txt)
+    for mode in "" --check-only; do
+        "$ymp" $mode -i "$input" -o "$work/$name.out"
+        if ! cmp -s "$inputs/$name.expected" "$work/$name.out"; then
+            echo "$name${mode:+ ($mode)}: output differs from $name.expected"
+            diff "$inputs/$name.expected" "$work/$name.out"
+            status=1
+        fi
+    done
+done
+exit $status
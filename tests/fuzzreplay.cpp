@@ -0,0 +1,29 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv);
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+// Feeds each file to the fuzz target once, the way libFuzzer replays a corpus,
+// so the target is exercised by toolchains without -fsanitize=fuzzer.
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("usage: fuzzreplay <input>...\n");
+        return 2;
+    }
+    LLVMFuzzerInitialize(&argc, &argv);
+    for (int i = 1; i < argc; i++) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::printf("cannot open %s\n", argv[i]);
+            return 1;
+        }
+        std::string input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "../ymp/alloctrack.h"
+#include "../ymp/compiler.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long long> hostAllocations(0);
+
+// The host routes its allocations through AllocTracker without registering
+// it, so the library must still report tracking as unavailable.
+void* operator new(size_t size) {
+    hostAllocations++;
+    void* pointer = AllocTracker::allocate(size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+    AllocTracker::deallocate(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    AllocTracker::deallocate(pointer);
+}
+
+static const char* const SOURCE = "int f(){\nint a, b;\nchar s;\na = 1;\nb = a + 2 - (a + 2);\ns = \"ab\" + \"cd\";\nreturn b;\n}\n";
+
+static AllocStats compileTracked(Compiler& compiler, AllocPhase phase) {
+    AllocTracker::reset();
+    AllocTracker::setEnabled(true);
+    compiler.compile(SOURCE);
+    AllocTracker::setEnabled(false);
+    return AllocTracker::phaseStats(phase);
+}
+
+// The analyzer and the IR are kept by the compiler, so compiling the same
+// input again must allocate less in those phases than the first compile did.
+static bool checkReuse(AllocPhase phase) {
+    Compiler compiler;
+    long long first = compileTracked(compiler, phase).count;
+    long long second = compileTracked(compiler, phase).count;
+    if (second >= first) {
+        std::printf("%s: a reused compiler allocated %lld times, a fresh one %lld\n", AllocTracker::phaseName(phase), second, first);
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    Compiler compiler;
+    long long before = hostAllocations;
+    const CompileResult& result = compiler.compile(SOURCE);
+    if (!result.success || result.output.find("0 RETURN") == std::string::npos) {
+        std::printf("unexpected compile result:\n%s\n", result.output.c_str());
+        return 1;
+    }
+    if (hostAllocations == before) {
+        std::printf("the host operator new was bypassed\n");
+        return 1;
+    }
+    if (AllocTracker::available()) {
+        std::printf("allocation tracking is active in a library build\n");
+        return 1;
+    }
+    bool reused = checkReuse(AllocPhase::SEMANTIC);
+    reused = checkReuse(AllocPhase::IR) && reused;
+    return reused ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+#include "../ymp/bytecode.h"
+#include "../ymp/ir.h"
+#include "../ymp/lexer.h"
+#include "../ymp/parser.h"
+#include "../ymp/semantic.h"
+#include "../ymp/vm.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+static const unsigned GENERATED_PROGRAMS = 300;
+
+class ProgramGenerator {
+private:
+    std::mt19937 random;
+    std::vector<std::string> intVars;
+    std::vector<std::string> charVars;
+    std::vector<std::string> subexpressions;
+    unsigned below(unsigned n) {
+        return random() % n;
+    }
+    bool chance(unsigned percent) {
+        return below(100) < percent;
+    }
+    const std::string& pick(const std::vector<std::string>& from) {
+        return from[below(static_cast<unsigned>(from.size()))];
+    }
+    std::string intExpression(int depth) {
+        if (!subexpressions.empty() && chance(30)) {
+            return pick(subexpressions);
+        }
+        unsigned kind = below(100);
+        if (depth > 2 || kind < 35) {
+            if (chance(70)) {
+                return pick(intVars);
+            }
+            return std::to_string(chance(10) ? 2147483647u - below(4) : below(51));
+        }
+        if (kind < 50) {
+            return "(" + intExpression(depth + 1) + ")";
+        }
+        std::string left = intExpression(depth + 1);
+        const char* op = chance(50) ? " + " : " - ";
+        std::string right = intExpression(depth + 1);
+        std::string expression = left + op + right;
+        if (chance(40)) {
+            subexpressions.push_back("(" + expression + ")");
+        }
+        if (chance(20)) {
+            subexpressions.push_back("(" + right + op + left + ")");
+        }
+        return expression;
+    }
+    std::string literal() {
+        static const char letters[] = "xyz ";
+        std::string text = "\"";
+        for (unsigned n = below(4); n > 0; n--) {
+            text += letters[below(4)];
+        }
+        return text + "\"";
+    }
+    std::string joined(unsigned count, bool literals) {
+        std::string expression;
+        for (unsigned i = 0; i < count; i++) {
+            expression += (i == 0 ? "" : " + ") + (literals ? literal() : pick(charVars));
+        }
+        return expression;
+    }
+public:
+    explicit ProgramGenerator(unsigned seed) : random(seed) {
+    }
+    std::string generate() {
+        static const char* const intNames[] = { "a", "b", "c", "d", "e", "f", "g", "h" };
+        static const char* const charNames[] = { "s", "t", "u" };
+        intVars.assign(intNames, intNames + 2 + below(7));
+        charVars.assign(charNames, charNames + 1 + below(3));
+        subexpressions.clear();
+        bool returnsChar = chance(30);
+        std::string source = returnsChar ? "char run(){\n" : "int run(){\n";
+        source += "int ";
+        for (size_t i = 0; i < intVars.size(); i++) {
+            source += (i == 0 ? "" : ", ") + intVars[i];
+        }
+        source += ";\nchar ";
+        for (size_t i = 0; i < charVars.size(); i++) {
+            source += (i == 0 ? "" : ", ") + charVars[i];
+        }
+        source += ";\n";
+        for (unsigned n = 3 + below(23); n > 0; n--) {
+            unsigned kind = below(100);
+            if (kind < 70) {
+                const std::string& target = pick(intVars);
+                std::string value = intExpression(0);
+                source += target + " = " + value + ";\n";
+            }
+            else {
+                const std::string& target = pick(charVars);
+                std::string value = kind < 85 ? joined(1 + below(3), true) : joined(1 + below(4), false);
+                source += target + " = " + value + ";\n";
+            }
+        }
+        source += "return " + pick(returnsChar ? charVars : intVars) + ";\n}\n";
+        return source;
+    }
+};
+
+static bool buildIr(const std::string& source, IrFunction& program) {
+    Lexer lexer(source.data(), source.size());
+    Parser parser(lexer);
+    std::shared_ptr<ParseTreeNode> syntaxTree = parser.parseFunction();
+    if (parser.hasErrors()) {
+        return false;
+    }
+    SemanticAnalyzer semanticAnalyzer;
+    semanticAnalyzer.analyze(syntaxTree);
+    if (semanticAnalyzer.hasErrors()) {
+        return false;
+    }
+    IrBuilder irBuilder;
+    program = irBuilder.build(syntaxTree);
+    return true;
+}
+
+static std::string execute(const IrFunction& program, bool peephole) {
+    BytecodeEmitter emitter;
+    BytecodeProgram bytecode = emitter.emit(program);
+    if (peephole) {
+        BytecodeOptimizer optimizer;
+        optimizer.run(bytecode);
+    }
+    VirtualMachine vm(bytecode);
+    vm.run();
+    if (!vm.hasResult()) {
+        return "none";
+    }
+    if (bytecode.returnType == IrType::CHAR_TYPE) {
+        return "\"" + vm.getStringResult() + "\"";
+    }
+    return std::to_string(vm.getIntResult());
+}
+
+// Runs the program at -O0, with only the bytecode peephole, with only
+// IrOptimizer and with both; all four must return the same value. Programs
+// that do not compile are skipped and not counted.
+static bool checkProgram(const std::string& name, const std::string& source, unsigned& checked) {
+    IrFunction program;
+    if (!buildIr(source, program)) {
+        return true;
+    }
+    checked++;
+    std::string results[4];
+    results[0] = execute(program, false);
+    results[1] = execute(program, true);
+    IrOptimizer optimizer;
+    optimizer.run(program);
+    results[2] = execute(program, false);
+    results[3] = execute(program, true);
+    static const char* const variants[4] = { "-O0", "the peephole", "optimized IR", "optimized IR with the peephole" };
+    for (int i = 1; i < 4; i++) {
+        if (results[i] != results[0]) {
+            std::printf("%s: -O0 returns %s, %s returns %s\n%s", name.c_str(), results[0].c_str(), variants[i], results[i].c_str(), source.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool ok = true;
+    unsigned checked = 0;
+    for (int i = 1; i < argc; i++) {
+        for (const auto& entry : std::filesystem::directory_iterator(argv[i])) {
+            std::ifstream file(entry.path());
+            std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            ok = checkProgram(entry.path().filename().string(), source, checked) && ok;
+        }
+    }
+    for (unsigned seed = 0; seed < GENERATED_PROGRAMS; seed++) {
+        ProgramGenerator generator(seed);
+        ok = checkProgram("generated " + std::to_string(seed), generator.generate(), checked) && ok;
+    }
+    std::printf("%u programs agree with and without optimization\n", checked);
+    return ok && checked >= GENERATED_PROGRAMS ? 0 : 1;
+}
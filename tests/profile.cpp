@@ -0,0 +1,118 @@
+#include "../ymp/bytecode.h"
+#include "../ymp/ir.h"
+#include "../ymp/lexer.h"
+#include "../ymp/parser.h"
+#include "../ymp/semantic.h"
+#include "../ymp/vm.h"
+#include <cstdio>
+#include <string>
+
+static const char* const SOURCE =
+    "int f(){\n"
+    "int a, b;\n"
+    "char s;\n"
+    "a = 1; b = a + 2\n"
+    " - a;\n"
+    "s = \"x\" + \"y\";\n"
+    "b = b + a + b;\n"
+    "return b;\n"
+    "}\n";
+
+static const char* const EXPECTED =
+    "=== PROFILE ===\n"
+    "Function: f\n"
+    "Runs: 3\n"
+    "Instructions executed: 60\n"
+    "Statement time: 1000 ns\n"
+    "\n"
+    "HOT STATEMENTS:\n"
+    " rank  line  executions     time ns   share  statement\n"
+    "    1     4           3         300   30.0%  a 2 + a - b =\n"
+    "    2     6           3         300   30.0%  \"x\" \"y\" + s =\n"
+    "    3     7           3         250   25.0%  b a + b + b =\n"
+    "    4     4           3         100   10.0%  1 a =\n"
+    "    5     8           3          50    5.0%  b RETURN\n"
+    "\n"
+    "SOURCE LINES:\n"
+    " line  executions  instructions     time ns\n"
+    "    4           6            24         400\n"
+    "    6           3            12         300\n"
+    "    7           3            18         250\n"
+    "    8           3             6          50\n"
+    "\n"
+    "INSTRUCTIONS:\n"
+    "   pc  line       count  instruction\n"
+    "    0     4           3  PUSH_INT 1\n"
+    "    1     4           3  STORE_INT a\n"
+    "    2     4           3  LOAD_INT a\n"
+    "    3     4           3  PUSH_INT 2\n"
+    "    4     4           3  ADD\n"
+    "    5     4           3  LOAD_INT a\n"
+    "    6     4           3  SUB\n"
+    "    7     4           3  STORE_INT b\n"
+    "    8     6           3  PUSH_STR \"x\"\n"
+    "    9     6           3  PUSH_STR \"y\"\n"
+    "   10     6           3  CONCAT\n"
+    "   11     6           3  STORE_STR s\n"
+    "   12     7           3  LOAD_INT b\n"
+    "   13     7           3  LOAD_INT a\n"
+    "   14     7           3  ADD\n"
+    "   15     7           3  LOAD_INT b\n"
+    "   16     7           3  ADD\n"
+    "   17     7           3  STORE_INT b\n"
+    "   18     8           3  LOAD_INT b\n"
+    "   19     8           3  RETURN_INT\n";
+
+// Runs the unoptimized bytecode three times under a profile. The counts come
+// from execution; the measured times are then replaced with fixed ones so the
+// ranking, shares and per-line time totals can be compared exactly. Equal
+// times keep program order.
+int main() {
+    std::string source = SOURCE;
+    Lexer lexer(source.data(), source.size());
+    Parser parser(lexer);
+    std::shared_ptr<ParseTreeNode> syntaxTree = parser.parseFunction();
+    SemanticAnalyzer semanticAnalyzer;
+    semanticAnalyzer.analyze(syntaxTree);
+    if (parser.hasErrors() || semanticAnalyzer.hasErrors()) {
+        std::printf("the profiled program does not compile\n");
+        return 1;
+    }
+    IrBuilder irBuilder;
+    IrFunction function = irBuilder.build(syntaxTree);
+    BytecodeEmitter emitter;
+    BytecodeProgram program = emitter.emit(function);
+
+    ExecutionProfile profile;
+    profile.reset(program);
+    VirtualMachine vm(program);
+    vm.setProfile(&profile);
+    for (int run = 0; run < 3; run++) {
+        vm.run();
+    }
+    if (!vm.hasResult() || vm.getIntResult() != 5) {
+        std::printf("the profiled run returned the wrong value\n");
+        return 1;
+    }
+
+    const long long times[] = { 100, 300, 300, 250, 50 };
+    if (profile.statementNs.size() != sizeof(times) / sizeof(times[0])) {
+        std::printf("expected 5 statements, found %zu\n", profile.statementNs.size());
+        return 1;
+    }
+    profile.totalNs = 0;
+    for (size_t s = 0; s < profile.statementNs.size(); s++) {
+        profile.statementNs[s] = times[s];
+        profile.totalNs += times[s];
+    }
+    std::string report;
+    StringSink sink(report);
+    OutputBuffer out(sink);
+    profile.report(program, out);
+    out.flush();
+    if (report != EXPECTED) {
+        std::printf("profile report differs; got:\n%s", report.c_str());
+        return 1;
+    }
+    return 0;
+}
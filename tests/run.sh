@@ -0,0 +1,73 @@
+#!/bin/sh
+# Builds ymp and the test programs with the system toolchain and runs every test.
+# Usage: tests/run.sh [build-dir]
+set -e
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+build=${1:-"$root/_test_build"}
+CXX=${CXX:-c++}
+CC=${CC:-cc}
+CXXFLAGS=${CXXFLAGS:-"-std=c++20 -O1 -Wall -Wno-sign-compare -pthread"}
+export CC
+
+mkdir -p "$build/obj"
+
+objects=""
+for source in "$root"/ymp/*.cpp; do
+    name=$(basename "$source" .cpp)
+    case "$name" in
+        FileName|allocnew|fuzz) continue ;;
+    esac
+    object="$build/obj/$name.o"
+    if [ ! -f "$object" ] || [ "$source" -nt "$object" ] || [ -n "$(find "$root/ymp" -name '*.h' -newer "$object")" ]; then
+        $CXX $CXXFLAGS -c -o "$object" "$source"
+    fi
+    objects="$objects $object"
+done
+$CXX $CXXFLAGS -DYMP_ALLOC_TRACKING -c -o "$build/allocnew.o" "$root/ymp/allocnew.cpp"
+$CXX $CXXFLAGS -o "$build/ymp" "$root/ymp/FileName.cpp" "$build/allocnew.o" $objects
+$CXX $CXXFLAGS -o "$build/fuzzreplay" "$root/tests/fuzzreplay.cpp" "$root/ymp/fuzz.cpp" "$build/allocnew.o" $objects
+
+failed=0
+program() {
+    $CXX $CXXFLAGS -o "$build/$1" "$root/tests/$1.cpp" $objects
+}
+run() {
+    label=$1
+    shift
+    if "$@"; then
+        echo "PASS $label"
+    else
+        echo "FAIL $label"
+        failed=1
+    fi
+}
+
+for test in library checker symtab tokenstream profile concurrenthashtable embedded tokenindex optimizer tracejson; do
+    program $test
+done
+$CXX $CXXFLAGS -o "$build/utf8" "$root/tests/utf8.cpp" "$root/ymp/sourcecheck.cpp"
+$CXX $CXXFLAGS -DYMP_NO_SSE2 -o "$build/utf8-wordmask" "$root/tests/utf8.cpp" "$root/ymp/sourcecheck.cpp"
+"$build/ymp" -i "$root/ymp/input.txt" -o "$build/input.out" --emit-tokens "$build/input.tok" || true
+
+run cbackend sh "$root/tests/cbackend.sh" "$build/ymp" "$root/tests/programs" "$build/cbackend"
+run cli sh "$root/tests/cli.sh" "$build/ymp" "$build/cli"
+run allocstats sh "$root/tests/allocstats.sh" "$build/ymp" "$build/allocstats"
+run warnings sh "$root/tests/warnings.sh" "$build/ymp" "$root/tests/warnings" "$build/warnings"
+run complexity sh "$root/tests/complexity.sh" "$build/ymp" "$root/tests/complexity" "$build/complexity"
+run trace sh "$root/tests/trace.sh" "$build/ymp" "$build/tracejson" "$root/tests/programs" "$build/trace"
+run fuzzreplay "$build/fuzzreplay" "$root"/tests/complexity/*.txt "$root"/tests/programs/*.txt "$root"/tests/invalid/*.txt
+run encoding sh "$root/tests/encoding.sh" "$build/ymp" "$root/tests/encoding" "$build/encoding"
+run utf8 "$build/utf8"
+run utf8-wordmask "$build/utf8-wordmask"
+run library "$build/library"
+run checker "$build/checker" "$root/tests/programs" "$root/tests/invalid" "$root/tests/complexity"
+run symtab "$build/symtab"
+run profile "$build/profile"
+run tokenstream "$build/tokenstream"
+run concurrenthashtable "$build/concurrenthashtable"
+run embedded "$build/embedded" "$root/tests/programs" "$root/tests/invalid"
+run tokenindex "$build/tokenindex" "$root/ymp/input.txt" "$build/input.tok"
+run optimizer "$build/optimizer" "$root/tests/programs"
+
+exit $failed
@@ -0,0 +1,80 @@
+#include "../ymp/symtab.h"
+#include <cstdio>
+#include <string>
+
+static bool ok = true;
+
+static void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("%s\n", what);
+        ok = false;
+    }
+}
+
+static bool isBound(ScopedSymbolTable& symbols, const std::string& name, SymbolType type, int line) {
+    const SymbolInfo* info = symbols.lookup(name);
+    return info != nullptr && info->name == name && info->type == type && info->line == line;
+}
+
+int main() {
+    ScopedSymbolTable symbols;
+    expect(symbols.depth() == 0, "a new table is not at depth 0");
+    expect(symbols.lookup("a") == nullptr, "a new table finds 'a'");
+
+    symbols.declare(SymbolInfo("a", SymbolType::INT_TYPE, 1));
+    symbols.enterScope();
+    expect(symbols.depth() == 1, "enterScope does not raise the depth");
+    expect(isBound(symbols, "a", SymbolType::INT_TYPE, 1), "an outer binding is not visible in an inner scope");
+    expect(symbols.lookupInCurrentScope("a") == nullptr, "an outer binding is found in the current scope");
+
+    symbols.declare(SymbolInfo("a", SymbolType::CHAR_TYPE, 2));
+    symbols.declare(SymbolInfo("b", SymbolType::INT_TYPE, 3));
+    expect(isBound(symbols, "a", SymbolType::CHAR_TYPE, 2), "an inner binding does not shadow the outer one");
+    expect(symbols.lookupInCurrentScope("a") != nullptr, "a shadowing binding is not in the current scope");
+
+    symbols.exitScope();
+    expect(symbols.depth() == 0, "exitScope does not lower the depth");
+    expect(isBound(symbols, "a", SymbolType::INT_TYPE, 1), "exitScope does not restore the shadowed binding");
+    expect(symbols.lookup("b") == nullptr, "exitScope leaves an inner binding visible");
+    symbols.exitScope();
+    expect(symbols.depth() == 0, "exitScope at the outermost scope changes the depth");
+
+    // Enough names to grow the slot array several times, each shadowed in a
+    // nested scope so that growing has to re-link the shadow chains.
+    const int NAMES = 1000;
+    for (int i = 0; i < NAMES; i++) {
+        symbols.declare(SymbolInfo("v" + std::to_string(i), SymbolType::INT_TYPE, i));
+    }
+    symbols.enterScope();
+    for (int i = 0; i < NAMES; i += 2) {
+        symbols.declare(SymbolInfo("v" + std::to_string(i), SymbolType::CHAR_TYPE, NAMES + i));
+    }
+    symbols.enterScope();
+    for (int i = NAMES; i < 2 * NAMES; i++) {
+        symbols.declare(SymbolInfo("v" + std::to_string(i), SymbolType::INT_TYPE, i));
+    }
+    bool found = true;
+    for (int i = 0; i < 2 * NAMES; i++) {
+        bool shadowed = i < NAMES && i % 2 == 0;
+        found = found && isBound(symbols, "v" + std::to_string(i), shadowed ? SymbolType::CHAR_TYPE : SymbolType::INT_TYPE, shadowed ? NAMES + i : i);
+    }
+    expect(found, "a binding is lost after the table grows");
+
+    symbols.exitScope();
+    symbols.exitScope();
+    found = true;
+    for (int i = 0; i < NAMES; i++) {
+        found = found && isBound(symbols, "v" + std::to_string(i), SymbolType::INT_TYPE, i);
+    }
+    for (int i = NAMES; i < 2 * NAMES; i++) {
+        found = found && symbols.lookup("v" + std::to_string(i)) == nullptr;
+    }
+    expect(found, "leaving scopes after growth does not restore the outer bindings");
+    expect(isBound(symbols, "a", SymbolType::INT_TYPE, 1), "growth loses the first binding");
+
+    symbols.clear();
+    expect(symbols.lookup("a") == nullptr && symbols.lookup("v0") == nullptr, "clear leaves bindings visible");
+    symbols.declare(SymbolInfo("a", SymbolType::CHAR_TYPE, 5));
+    expect(isBound(symbols, "a", SymbolType::CHAR_TYPE, 5), "a table is unusable after clear");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+#include "../ymp/lexer.h"
+#include "../ymp/tokenindex.h"
+#include "../ymp/tokenstream.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+static bool rejects(const std::vector<uint32_t>& storage, size_t length, const char* what) {
+    TokenIndex index;
+    if (index.attach(reinterpret_cast<const char*>(storage.data()), length)) {
+        std::printf("a %s index was accepted\n", what);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::printf("usage: tokenindex <source> <index>\n");
+        return 2;
+    }
+    std::ifstream file(argv[1]);
+    std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    TokenIndex index;
+    if (!index.open(argv[2])) {
+        std::printf("cannot open %s: %s\n", argv[2], index.error().c_str());
+        return 1;
+    }
+    if (!index.verify() || index.sharedLexemes()) {
+        std::printf("%s does not verify\n", argv[2]);
+        return 1;
+    }
+    Lexer lexer(source.data(), source.size());
+    uint32_t position = 0;
+    for (const Token& token : lexTokens(lexer)) {
+        if (position >= index.tokenCount()) {
+            std::printf("index has %u tokens, the source has more\n", index.tokenCount());
+            return 1;
+        }
+        const TokenRecord& record = index.token(position);
+        if (index.lexeme(record.lexeme()) != token.value || record.kind() != token.type || record.offset != static_cast<uint32_t>(token.offset)) {
+            std::printf("token %u: index has '%.*s' at %u, lexer has '%s' at %d\n", position,
+                static_cast<int>(index.lexeme(record.lexeme()).size()), index.lexeme(record.lexeme()).data(), record.offset, token.value.c_str(), token.offset);
+            return 1;
+        }
+        position++;
+    }
+    if (position != index.tokenCount()) {
+        std::printf("index has %u tokens, the source has %u\n", index.tokenCount(), position);
+        return 1;
+    }
+
+    std::ifstream raw(argv[2], std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(raw)), std::istreambuf_iterator<char>());
+    std::vector<uint32_t> storage(bytes.size() / 4 + 1);
+    std::memcpy(storage.data(), bytes.data(), bytes.size());
+    TokenIndex attached;
+    if (!attached.attach(reinterpret_cast<const char*>(storage.data()), bytes.size()) || attached.tokenCount() != index.tokenCount()) {
+        std::printf("attach does not match open: %s\n", attached.error().c_str());
+        return 1;
+    }
+    if (!rejects(storage, sizeof(TokenIndexHeader) - 1, "truncated") || !rejects(storage, bytes.size() - 1, "shortened")) {
+        return 1;
+    }
+    reinterpret_cast<char*>(storage.data())[0] = 'X';
+    return rejects(storage, bytes.size(), "mislabelled") ? 0 : 1;
+}
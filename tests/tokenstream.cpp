@@ -0,0 +1,35 @@
+#include "../ymp/lexer.h"
+#include "../ymp/tokenstream.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+int main() {
+    std::string source = "int f(){\nint a, b;\na = b + 12;\nreturn a;\n}\n";
+    std::vector<Token> expected;
+    Lexer reference(source.data(), source.size());
+    for (const Token& token : lexTokens(reference)) {
+        expected.push_back(token);
+    }
+
+    Lexer lexer(source.data(), source.size());
+    TokenStream tokens(lexer);
+    for (size_t i = 0; i < expected.size(); i++) {
+        const Token* lookahead[TokenStream::MAX_LOOKAHEAD] = {
+            &tokens.peek<0>(), &tokens.peek<1>(), &tokens.peek<2>(), &tokens.peek<3>()
+        };
+        for (size_t k = 0; k < TokenStream::MAX_LOOKAHEAD && i + k < expected.size(); k++) {
+            if (lookahead[k]->type != expected[i + k].type || lookahead[k]->value != expected[i + k].value) {
+                std::printf("peek<%zu> at token %zu returned '%s', expected '%s'\n", k, i, lookahead[k]->value.c_str(), expected[i + k].value.c_str());
+                return 1;
+            }
+        }
+        Token token;
+        tokens.next(token);
+        if (token.type != expected[i].type || token.value != expected[i].value) {
+            std::printf("next at token %zu returned '%s', expected '%s'\n", i, token.value.c_str(), expected[i].value.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
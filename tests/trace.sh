@@ -0,0 +1,39 @@
+#!/bin/sh
+# Checks that --trace writes valid trace-event JSON with a span for every phase,
+# in single-file, batch and statement-level modes.
+# Usage: trace.sh <ymp> <tracejson> <programs-dir> <work-dir>
+ymp=$1
+tracejson=$2
+programs=$3
+work=$4
+mkdir -p "$work/batch"
+
+phases="checkEncoding Lexer Parser::parseFunction SemanticAnalyzer::analyze IrBuilder::build DataflowAnalyzer::run IrOptimizer::run generatePostfix"
+
+status=0
+check() {
+    if ! "$tracejson" "$@"; then
+        status=1
+    fi
+}
+
+program=$(ls "$programs"/*.txt | head -n 1)
+"$ymp" -i "$program" -o "$work/single.out" --trace "$work/single.json"
+check "$work/single.json" $phases
+
+"$ymp" -i "$program" -o "$work/tokens.out" --emit-tokens "$work/tokens.tok" --trace "$work/tokens.json"
+check "$work/tokens.json" $phases
+
+"$ymp" -i "$program" -o "$work/statements.out" --trace "$work/statements.json" --trace-statements
+check "$work/statements.json" $phases Descr Op
+
+for source in "$programs"/*.txt; do
+    cp "$source" "$work/batch/"
+done
+cp "$program" "$work/batch/quote\"and\\backslash.txt"
+"$ymp" -j 2 "$work"/batch/*.txt --trace "$work/batch.json"
+check "$work/batch.json" compile $phases
+
+"$ymp" -i "$program" -o "$work/check.out" --check-only --trace "$work/check.json"
+check "$work/check.json" checkEncoding Checker::check
+exit $status
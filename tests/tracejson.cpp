@@ -0,0 +1,275 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+// A JSON value with just enough structure to walk a trace-event file.
+struct JsonValue {
+    enum Kind { NULL_VALUE, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT } kind = NULL_VALUE;
+    double number = 0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::map<std::string, JsonValue> members;
+    const JsonValue* member(const std::string& name) const {
+        auto it = members.find(name);
+        return it == members.end() ? nullptr : &it->second;
+    }
+};
+
+class JsonParser {
+private:
+    const std::string& input;
+    size_t position;
+    std::string error;
+    void skipSpace() {
+        while (position < input.size() && (input[position] == ' ' || input[position] == '\n' || input[position] == '\r' || input[position] == '\t')) {
+            position++;
+        }
+    }
+    bool fail(const char* message) {
+        if (error.empty()) {
+            error = std::string(message) + " at byte " + std::to_string(position);
+        }
+        return false;
+    }
+    bool literal(const char* word) {
+        size_t length = std::char_traits<char>::length(word);
+        if (input.compare(position, length, word) != 0) {
+            return fail("invalid literal");
+        }
+        position += length;
+        return true;
+    }
+    bool parseString(std::string& out) {
+        position++;
+        while (position < input.size()) {
+            char c = input[position++];
+            if (c == '"') {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return fail("control character in string");
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (position >= input.size()) {
+                break;
+            }
+            char escape = input[position++];
+            switch (escape) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                if (position + 4 > input.size()) {
+                    return fail("truncated \\u escape");
+                }
+                char* end = nullptr;
+                std::string digits = input.substr(position, 4);
+                long code = std::strtol(digits.c_str(), &end, 16);
+                if (end != digits.c_str() + 4) {
+                    return fail("invalid \\u escape");
+                }
+                position += 4;
+                if (code >= 0x80) {
+                    return fail("\\u escape outside ASCII");
+                }
+                out += static_cast<char>(code);
+                break;
+            }
+            default:
+                return fail("invalid escape");
+            }
+        }
+        return fail("unterminated string");
+    }
+    bool parseNumber(double& out) {
+        size_t start = position;
+        if (input[position] == '-') {
+            position++;
+        }
+        size_t digits = position;
+        while (position < input.size() && input[position] >= '0' && input[position] <= '9') {
+            position++;
+        }
+        if (position == digits) {
+            return fail("invalid number");
+        }
+        if (position < input.size() && input[position] == '.') {
+            size_t fraction = ++position;
+            while (position < input.size() && input[position] >= '0' && input[position] <= '9') {
+                position++;
+            }
+            if (position == fraction) {
+                return fail("invalid fraction");
+            }
+        }
+        out = std::strtod(input.substr(start, position - start).c_str(), nullptr);
+        return true;
+    }
+    bool parseValue(JsonValue& value) {
+        skipSpace();
+        if (position >= input.size()) {
+            return fail("unexpected end of input");
+        }
+        char c = input[position];
+        if (c == '{') {
+            value.kind = JsonValue::OBJECT;
+            position++;
+            skipSpace();
+            if (position < input.size() && input[position] == '}') {
+                position++;
+                return true;
+            }
+            for (;;) {
+                skipSpace();
+                std::string name;
+                if (position >= input.size() || input[position] != '"' || !parseString(name)) {
+                    return fail("expected member name");
+                }
+                skipSpace();
+                if (position >= input.size() || input[position++] != ':') {
+                    return fail("expected ':'");
+                }
+                if (value.members.count(name) != 0) {
+                    return fail("duplicate member");
+                }
+                if (!parseValue(value.members[name])) {
+                    return false;
+                }
+                skipSpace();
+                if (position < input.size() && input[position] == ',') {
+                    position++;
+                    continue;
+                }
+                if (position < input.size() && input[position] == '}') {
+                    position++;
+                    return true;
+                }
+                return fail("expected ',' or '}'");
+            }
+        }
+        if (c == '[') {
+            value.kind = JsonValue::ARRAY;
+            position++;
+            skipSpace();
+            if (position < input.size() && input[position] == ']') {
+                position++;
+                return true;
+            }
+            for (;;) {
+                value.items.emplace_back();
+                if (!parseValue(value.items.back())) {
+                    return false;
+                }
+                skipSpace();
+                if (position < input.size() && input[position] == ',') {
+                    position++;
+                    continue;
+                }
+                if (position < input.size() && input[position] == ']') {
+                    position++;
+                    return true;
+                }
+                return fail("expected ',' or ']'");
+            }
+        }
+        if (c == '"') {
+            value.kind = JsonValue::STRING;
+            return parseString(value.text);
+        }
+        if (c == 't' || c == 'f') {
+            value.kind = JsonValue::BOOLEAN;
+            value.number = c == 't' ? 1 : 0;
+            return literal(c == 't' ? "true" : "false");
+        }
+        if (c == 'n') {
+            return literal("null");
+        }
+        value.kind = JsonValue::NUMBER;
+        return parseNumber(value.number);
+    }
+public:
+    explicit JsonParser(const std::string& text) : input(text), position(0) {
+    }
+    bool parse(JsonValue& root) {
+        if (!parseValue(root)) {
+            return false;
+        }
+        skipSpace();
+        return position == input.size() || fail("trailing data");
+    }
+    const std::string& getError() const {
+        return error;
+    }
+};
+
+static bool isNumber(const JsonValue& event, const char* name) {
+    const JsonValue* value = event.member(name);
+    return value != nullptr && value->kind == JsonValue::NUMBER && value->number >= 0;
+}
+
+static bool isString(const JsonValue& event, const char* name) {
+    const JsonValue* value = event.member(name);
+    return value != nullptr && value->kind == JsonValue::STRING;
+}
+
+// Checks that a --trace file is well-formed trace-event JSON made of complete
+// ("X") events, and that every span named on the command line is present.
+// File spans must carry the input path in args.file.
+// Usage: tracejson <trace.json> <span-name>...
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("usage: tracejson <trace.json> <span-name>...\n");
+        return 2;
+    }
+    std::ifstream file(argv[1]);
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    JsonValue root;
+    JsonParser parser(text);
+    if (!parser.parse(root)) {
+        std::printf("%s: %s\n", argv[1], parser.getError().c_str());
+        return 1;
+    }
+    const JsonValue* events = root.kind == JsonValue::OBJECT ? root.member("traceEvents") : nullptr;
+    if (events == nullptr || events->kind != JsonValue::ARRAY) {
+        std::printf("%s: no traceEvents array\n", argv[1]);
+        return 1;
+    }
+    bool ok = true;
+    std::map<std::string, int> spans;
+    for (const JsonValue& event : events->items) {
+        const JsonValue* phase = event.member("ph");
+        if (!isString(event, "name") || !isString(event, "cat") || phase == nullptr || phase->text != "X"
+            || !isNumber(event, "ts") || !isNumber(event, "dur") || !isNumber(event, "pid") || !isNumber(event, "tid")) {
+            std::printf("%s: malformed event %d\n", argv[1], static_cast<int>(&event - events->items.data()));
+            ok = false;
+            continue;
+        }
+        if (event.member("cat")->text == "file") {
+            const JsonValue* args = event.member("args");
+            if (args == nullptr || args->kind != JsonValue::OBJECT || !isString(*args, "file")) {
+                std::printf("%s: file span without args.file\n", argv[1]);
+                ok = false;
+            }
+        }
+        spans[event.member("name")->text]++;
+    }
+    for (int i = 2; i < argc; i++) {
+        if (spans.count(argv[i]) == 0) {
+            std::printf("%s: no '%s' span\n", argv[1], argv[i]);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
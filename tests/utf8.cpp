@@ -0,0 +1,85 @@
+#include "../ymp/sourcecheck.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct Sequence {
+    const char* name;
+    std::string bytes;
+};
+
+static bool ok = true;
+
+static void expectOffsets(const std::string& text, bool ascii, const std::vector<size_t>& offsets, const char* what, size_t at) {
+    EncodingCheck check = checkEncoding(text.data(), text.size());
+    if (check.ascii != ascii || check.invalidOffsets != offsets) {
+        std::printf("%s at byte %zu: ascii %d, %zu invalid offsets", what, at, check.ascii, check.invalidOffsets.size());
+        for (size_t offset : check.invalidOffsets) {
+            std::printf(" %zu", offset);
+        }
+        std::printf("\n");
+        ok = false;
+    }
+}
+
+// Places each sequence at every offset across several 16- and 8-byte chunks
+// of ASCII text, so both the SSE2 and the word-mask scan hit it at every
+// alignment and with ASCII text after it.
+int main() {
+    const size_t SPAN = 48;
+    const Sequence valid[] = {
+        { "two-byte", "\xc3\xa9" },
+        { "three-byte", "\xe2\x82\xac" },
+        { "four-byte", "\xf0\x9f\x98\x80" },
+        { "largest code point", "\xf4\x8f\xbf\xbf" },
+        { "last before surrogates", "\xed\x9f\xbf" },
+    };
+    const Sequence invalid[] = {
+        { "stray continuation", "\x80" },
+        { "0xff", "\xff" },
+        { "overlong two-byte", "\xc0\xaf" },
+        { "overlong two-byte 0xc1", "\xc1\xbf" },
+        { "overlong three-byte", "\xe0\x80\xaf" },
+        { "overlong four-byte", "\xf0\x80\x80\xaf" },
+        { "high surrogate", "\xed\xa0\x80" },
+        { "low surrogate", "\xed\xbf\xbf" },
+        { "above U+10FFFF", "\xf4\x90\x80\x80" },
+        { "0xf5 lead", "\xf5\x80\x80\x80" },
+        { "missing continuation", "\xe2\x82(" },
+    };
+    for (size_t length = 0; length <= SPAN; length++) {
+        expectOffsets(std::string(length, 'a'), true, {}, "ASCII text", length);
+    }
+    for (const Sequence& sequence : valid) {
+        for (size_t at = 0; at <= SPAN; at++) {
+            std::string text = std::string(at, 'a') + sequence.bytes + std::string(SPAN, 'b');
+            expectOffsets(text, false, {}, sequence.name, at);
+        }
+    }
+    for (const Sequence& sequence : invalid) {
+        for (size_t at = 0; at <= SPAN; at++) {
+            std::string text = std::string(at, 'a') + sequence.bytes + std::string(SPAN, 'b');
+            expectOffsets(text, false, { at }, sequence.name, at);
+            std::string twice = text + sequence.bytes;
+            expectOffsets(twice, false, { at, text.size() }, sequence.name, at);
+        }
+    }
+    for (const Sequence& sequence : valid) {
+        for (size_t cut = 1; cut < sequence.bytes.size(); cut++) {
+            for (size_t at = 0; at <= SPAN; at++) {
+                std::string text = std::string(at, 'a') + sequence.bytes.substr(0, cut);
+                expectOffsets(text, false, { at }, "truncated tail", at);
+            }
+        }
+    }
+    std::string many;
+    std::vector<size_t> reported;
+    for (size_t i = 0; i < MAX_ENCODING_ERRORS * 2; i++) {
+        if (reported.size() < MAX_ENCODING_ERRORS) {
+            reported.push_back(many.size() + 2);
+        }
+        many += "ab\xff";
+    }
+    expectOffsets(many, false, reported, "error limit", 0);
+    return ok ? 0 : 1;
+}
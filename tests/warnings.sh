@@ -0,0 +1,27 @@
+#!/bin/sh
+# Compiles each input with -Wall at -O0 and compares the whole output with the
+# .expected file next to it. The optimized build must print the same warnings.
+# Usage: warnings.sh <ymp> <inputs-dir> <work-dir>
+ymp=$1
+inputs=$2
+work=$3
+mkdir -p "$work"
+
+status=0
+for input in "$inputs"/*.txt; do
+    name=$(basename "$input" .txt)
+    "$ymp" -Wall -O0 -i "$input" -o "$work/$name.out"
+    if ! cmp -s "$inputs/$name.expected" "$work/$name.out"; then
+        echo "$name: -Wall -O0 output differs from $name.expected"
+        diff "$inputs/$name.expected" "$work/$name.out"
+        status=1
+    fi
+    "$ymp" -Wall -i "$input" -o "$work/$name.optimized"
+    sed '/^=== POSTFIX NOTATION ===$/,$d' "$inputs/$name.expected" > "$work/$name.warnings"
+    sed '/^=== POSTFIX NOTATION ===$/,$d' "$work/$name.optimized" > "$work/$name.optimized.warnings"
+    if ! cmp -s "$work/$name.warnings" "$work/$name.optimized.warnings"; then
+        echo "$name: warnings differ with the optimizer on"
+        status=1
+    fi
+done
+exit $status
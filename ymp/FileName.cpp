@@ -1,47 +1,389 @@
 #include "lexer.h"
+#include "asyncwriter.h"
+#include "concurrenthashtable.h"
 #include "hashtable.h"
-#include "parser.h"
-#include "semantic.h"
+#include "tokenindex.h"
+#include "compiler.h"
+#include "complexity.h"
+#include "alloctrack.h"
+#include "tokenstream.h"
+#include "trace.h"
+#include <atomic>
+#include <charconv>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
 
-int main() {
-    Lexer lexer("input.txt");
+static bool readFile(const std::string& filename, std::string& contents) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static void buildLexemeTable(const std::string& source) {
+    TraceScope scope("Lexer", "phase");
+    AllocPhaseScope allocPhase(AllocPhase::LEXER);
+    AllocCategoryScope allocCategory(AllocCategory::LEXEME_TABLE);
+    Lexer lexer(source.data(), source.size());
     HashTable hashTable;
-    Token token = lexer.getNextToken();
-    int tokenCount = 0;
-    while (token.type != TokenType::END_OF_FILE) {
-        tokenCount++;
-        int index = hashTable.insert(token);
-        token = lexer.getNextToken();
-    }
-    std::ofstream outFile("output.txt");
-    Lexer parserLexer("input.txt");
-    Parser parser(parserLexer);
-    auto syntaxTree = parser.parseFunction();
-    if (parser.hasErrors()) {
-        outFile << "SYNTAX ERRORS:" << std::endl;
-        for (const auto& error : parser.getErrors()) {
-            outFile << error << std::endl;
-        }
-    }
-    else {
-        outFile << "No syntax errors found." << std::endl;
-    }
-    if (!parser.hasErrors()) {
-        SemanticAnalyzer semanticAnalyzer;
-        semanticAnalyzer.analyze(syntaxTree);
-        if (semanticAnalyzer.hasErrors()) {
-            outFile << "SEMANTIC ERRORS:" << std::endl;
-            for (const auto& error : semanticAnalyzer.getErrors()) {
-                outFile << error << std::endl;
+    for (const Token& token : lexTokens(lexer)) {
+        hashTable.insert(token);
+    }
+}
+
+static bool buildTokenIndex(const std::string& source, std::string& out) {
+    TraceScope scope("Lexer", "phase");
+    AllocPhaseScope allocPhase(AllocPhase::LEXER);
+    AllocCategoryScope allocCategory(AllocCategory::LEXEME_TABLE);
+    Lexer lexer(source.data(), source.size());
+    TokenIndexWriter index;
+    for (const Token& token : lexTokens(lexer)) {
+        index.add(token);
+    }
+    return index.finish(out);
+}
+
+static bool buildSharedTokenIndex(const std::string& source, std::string& out, ConcurrentHashTable& lexemes) {
+    TraceScope scope("Lexer", "phase");
+    AllocPhaseScope allocPhase(AllocPhase::LEXER);
+    AllocCategoryScope allocCategory(AllocCategory::LEXEME_TABLE);
+    Lexer lexer(source.data(), source.size());
+    TokenIndexWriter index;
+    for (const Token& token : lexTokens(lexer)) {
+        index.add(token, lexemes.insert(token));
+    }
+    return index.finish(out);
+}
+
+static bool exportLexemeTable(ConcurrentHashTable& lexemes, std::string& out) {
+    std::vector<Token> entries;
+    lexemes.snapshot(entries);
+    TokenIndexWriter index;
+    for (size_t i = 0; i < entries.size(); i++) {
+        index.addLexeme(static_cast<int>(i), entries[i]);
+    }
+    return index.finish(out);
+}
+
+static int compileBatch(const std::vector<std::string>& inputs, const CompileOptions& options, unsigned jobs, const std::string& tokensPath) {
+    std::atomic<size_t> next(0);
+    std::atomic<int> failures(0);
+    AsyncWriter writer;
+    ConcurrentHashTable lexemes;
+    auto worker = [&]() {
+        Compiler compiler;
+        std::string source;
+        std::string tokenIndex;
+        for (size_t i = next++; i < inputs.size(); i = next++) {
+            TraceScope scope("compile", "file", TraceLevel::PHASES, "file", inputs[i]);
+            if (!readFile(inputs[i], source)) {
+                failures++;
+                continue;
+            }
+            compiler.compile(source, options);
+            CompileResult& result = compiler.result();
+            writer.writeFileFrom(inputs[i] + ".out", result.output);
+            if (options.emitC && !result.cSource.empty()) {
+                writer.writeFileFrom(inputs[i] + ".c", result.cSource);
             }
+            if (!result.profileReport.empty()) {
+                writer.writeFileFrom(inputs[i] + ".prof", result.profileReport);
+            }
+            if (!result.bytecode.empty()) {
+                writer.writeFileFrom(inputs[i] + ".bc", result.bytecode);
+            }
+            if (!options.checkOnly && !result.inputRejected) {
+                if (tokensPath.empty()) {
+                    buildLexemeTable(source);
+                }
+                else if (buildSharedTokenIndex(source, tokenIndex, lexemes)) {
+                    writer.writeFileFrom(inputs[i] + ".tok", tokenIndex);
+                }
+                else {
+                    failures++;
+                }
+            }
+            if (!result.success) {
+                failures++;
+            }
+        }
+    };
+    if (jobs > inputs.size()) {
+        jobs = static_cast<unsigned>(inputs.size());
+    }
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < jobs; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (!tokensPath.empty()) {
+        std::string lexicon;
+        if (exportLexemeTable(lexemes, lexicon)) {
+            writer.writeFile(tokensPath, std::move(lexicon));
+        }
+        else {
+            failures++;
+        }
+    }
+    writer.drain();
+    return failures == 0 && writer.failed() == 0 ? 0 : 1;
+}
+
+static int checkComplexity(const std::vector<std::string>& inputs, const CompileOptions& options, const ComplexityBudget& budget, const std::string& slowestPath) {
+    ComplexityProbe probe(options);
+    std::string source;
+    std::string violation;
+    size_t failures = 0;
+    for (const std::string& input : inputs) {
+        if (!readFile(input, source)) {
+            std::cerr << "Cannot open '" << input << "'" << std::endl;
+            failures++;
+            continue;
+        }
+        probe.record(source);
+        if (!checkBudget(probe.getMeasurement(), budget, violation)) {
+            std::cout << "OVER BUDGET " << input << ": " << violation << std::endl;
+            failures++;
+        }
+    }
+    std::string report;
+    StringSink sink(report);
+    OutputBuffer out(sink);
+    probe.report(out);
+    out.flush();
+    std::cout << report << "\n" << inputs.size() << " inputs, " << failures << " over budget" << std::endl;
+    if (!slowestPath.empty()) {
+        probe.writeSlowest(slowestPath);
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+static void writeTrace(Tracer& tracer, const std::string& filename) {
+    int fd = AsyncWriter::openForWrite(filename);
+    if (fd < 0) {
+        std::cerr << "Cannot write '" << filename << "'" << std::endl;
+        return;
+    }
+    AsyncWriter writer;
+    {
+        AsyncSink sink(writer, fd);
+        OutputBuffer out(sink);
+        tracer.write(out);
+    }
+    writer.close(fd);
+}
+
+static std::string allocationReport() {
+    AllocTracker::setEnabled(false);
+    std::string report;
+    StringSink sink(report);
+    OutputBuffer out(sink);
+    AllocTracker::report(out);
+    out.flush();
+    return report;
+}
+
+static int compileSingle(const std::string& inputPath, const std::string& outputPath, const std::string& cOutputPath, const std::string& profilePath, const std::string& bytecodePath, const std::string& tokensPath, const CompileOptions& options, bool allocStats) {
+    std::string source;
+    if (!readFile(inputPath, source)) {
+        std::cerr << "Cannot open '" << inputPath << "'" << std::endl;
+        return 2;
+    }
+    AsyncWriter writer;
+    Compiler compiler;
+    compiler.compile(source, options);
+    CompileResult& result = compiler.result();
+    if (!allocStats) {
+        writer.writeFileFrom(outputPath, result.output);
+    }
+    if (!cOutputPath.empty() && !result.cSource.empty()) {
+        writer.writeFileFrom(cOutputPath, result.cSource);
+    }
+    if (!profilePath.empty() && !result.profileReport.empty()) {
+        writer.writeFileFrom(profilePath, result.profileReport);
+    }
+    if (!bytecodePath.empty() && !result.bytecode.empty()) {
+        writer.writeFileFrom(bytecodePath, result.bytecode);
+    }
+    if (!options.checkOnly && !result.inputRejected) {
+        if (tokensPath.empty()) {
+            buildLexemeTable(source);
         }
         else {
-            outFile << "No semantic errors found." << std::endl;
+            std::string tokenIndex;
+            if (!buildTokenIndex(source, tokenIndex)) {
+                std::cerr << "Token index for '" << inputPath << "' is too large" << std::endl;
+                return 2;
+            }
+            writer.writeFile(tokensPath, std::move(tokenIndex));
         }
-        semanticAnalyzer.generatePostfix(syntaxTree, outFile);
     }
-    outFile.close();
-    return 0;
-}
\ No newline at end of file
+    if (allocStats) {
+        result.output += allocationReport();
+        writer.writeFileFrom(outputPath, result.output);
+    }
+    writer.drain();
+    if (writer.failed() != 0) {
+        std::cerr << "Cannot write output for '" << inputPath << "'" << std::endl;
+        return 2;
+    }
+    return result.success ? 0 : 1;
+}
+
+template <typename T>
+static bool parseNumber(const char* text, T& value) {
+    const char* end = text + std::strlen(text);
+    auto [stop, error] = std::from_chars(text, end, value);
+    return error == std::errc() && stop == end && stop != text;
+}
+
+static int invalidValue(const std::string& option, const char* value) {
+    std::cerr << "Invalid value '" << value << "' for option '" << option << "'" << std::endl;
+    return 2;
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputPath = "input.txt";
+    std::string outputPath = "output.txt";
+    std::string cOutputPath;
+    std::string tracePath;
+    std::string profilePath;
+    std::string bytecodePath;
+    std::string tokensPath;
+    TraceLevel traceLevel = TraceLevel::PHASES;
+    unsigned jobs = std::thread::hardware_concurrency();
+    std::vector<std::string> batchInputs;
+    bool allocStats = false;
+    bool complexityCheck = false;
+    std::string slowestPath;
+    ComplexityBudget budget;
+    CompileOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-O0") {
+            options.optimize = false;
+        }
+        else if (arg == "--max-errors" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], options.maxErrors)) {
+                return invalidValue(arg, argv[i]);
+            }
+        }
+        else if (arg == "--check-only") {
+            options.checkOnly = true;
+        }
+        else if (arg == "-Wall") {
+            options.warnings = true;
+        }
+        else if (arg == "--all-errors") {
+            options.allErrors = true;
+        }
+        else if (arg == "--emit-c" && i + 1 < argc) {
+            cOutputPath = argv[++i];
+            options.emitC = true;
+        }
+        else if (arg == "--profile" && i + 1 < argc) {
+            profilePath = argv[++i];
+            if (options.profileRuns == 0) {
+                options.profileRuns = 1;
+            }
+        }
+        else if (arg == "--profile-runs" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], options.profileRuns)) {
+                return invalidValue(arg, argv[i]);
+            }
+        }
+        else if (arg == "--emit-bytecode" && i + 1 < argc) {
+            bytecodePath = argv[++i];
+            options.emitBytecode = true;
+        }
+        else if (arg == "--emit-tokens" && i + 1 < argc) {
+            tokensPath = argv[++i];
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        }
+        else if (arg == "--trace-statements") {
+            traceLevel = TraceLevel::STATEMENTS;
+        }
+        else if (arg == "--complexity-check") {
+            complexityCheck = true;
+        }
+        else if (arg == "--budget-ns-per-byte" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], budget.nsPerByte)) {
+                return invalidValue(arg, argv[i]);
+            }
+        }
+        else if (arg == "--budget-allocs-per-byte" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], budget.allocationsPerByte)) {
+                return invalidValue(arg, argv[i]);
+            }
+        }
+        else if (arg == "--budget-bytes-per-byte" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], budget.peakBytesPerByte)) {
+                return invalidValue(arg, argv[i]);
+            }
+        }
+        else if (arg == "--slowest" && i + 1 < argc) {
+            slowestPath = argv[++i];
+        }
+        else if (arg == "--alloc-stats") {
+            allocStats = true;
+        }
+        else if (arg == "-j" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], jobs)) {
+                return invalidValue(arg, argv[i]);
+            }
+        }
+        else if (arg == "-i" && i + 1 < argc) {
+            inputPath = argv[++i];
+        }
+        else if (arg == "-o" && i + 1 < argc) {
+            outputPath = argv[++i];
+        }
+        else if (!arg.empty() && arg[0] != '-') {
+            batchInputs.push_back(arg);
+        }
+        else {
+            std::cerr << "Unknown option '" << arg << "'" << std::endl;
+            return 2;
+        }
+    }
+    if (jobs == 0) {
+        jobs = 1;
+    }
+    if (complexityCheck) {
+        if (batchInputs.empty()) {
+            batchInputs.push_back(inputPath);
+        }
+        return checkComplexity(batchInputs, options, budget, slowestPath);
+    }
+    Tracer tracer(traceLevel);
+    if (!tracePath.empty()) {
+        Tracer::setActive(&tracer);
+    }
+    if (allocStats) {
+        AllocTracker::reset();
+        AllocTracker::setEnabled(true);
+    }
+    int status = batchInputs.empty()
+        ? compileSingle(inputPath, outputPath, cOutputPath, profilePath, bytecodePath, tokensPath, options, allocStats)
+        : compileBatch(batchInputs, options, jobs, tokensPath);
+    if (allocStats && !batchInputs.empty()) {
+        std::cout << allocationReport();
+    }
+    if (!tracePath.empty()) {
+        Tracer::setActive(nullptr);
+        writeTrace(tracer, tracePath);
+    }
+    return status;
+}
@@ -0,0 +1,73 @@
+#ifdef YMP_ALLOC_TRACKING
+
+#include "alloctrack.h"
+#include <cstddef>
+#include <new>
+
+namespace {
+
+void* throwingAllocate(size_t size) {
+    for (;;) {
+        void* pointer = AllocTracker::allocate(size);
+        if (pointer != nullptr) {
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+struct TrackingRegistration {
+    TrackingRegistration() {
+        AllocTracker::setAvailable();
+    }
+};
+
+TrackingRegistration registration;
+
+}
+
+void* operator new(size_t size) {
+    return throwingAllocate(size);
+}
+
+void* operator new[](size_t size) {
+    return throwingAllocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return AllocTracker::allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return AllocTracker::allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    AllocTracker::deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    AllocTracker::deallocate(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    AllocTracker::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    AllocTracker::deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    AllocTracker::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    AllocTracker::deallocate(pointer);
+}
+
+#endif
@@ -0,0 +1,200 @@
+#include "alloctrack.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const int PHASE_COUNT = static_cast<int>(AllocPhase::COUNT);
+const int CATEGORY_COUNT = static_cast<int>(AllocCategory::COUNT);
+const unsigned char UNTRACKED = 0xff;
+
+struct Counter {
+    std::atomic<long long> count;
+    std::atomic<long long> bytes;
+    std::atomic<long long> liveBytes;
+    std::atomic<long long> peakLiveBytes;
+};
+
+Counter phaseCounters[PHASE_COUNT];
+Counter categoryCounters[CATEGORY_COUNT];
+Counter totalCounter;
+std::atomic<bool> trackingEnabled(false);
+thread_local unsigned char currentPhase = 0;
+thread_local unsigned char currentCategory = 0;
+
+const char* const phaseNames[PHASE_COUNT] = {
+    "other", "lexer", "parser", "semantic", "ir", "emit", "codegen"
+};
+
+const char* const categoryNames[CATEGORY_COUNT] = {
+    "other", "tokens", "parse tree", "symbol table", "lexeme table", "diagnostics", "ir", "output"
+};
+
+void addAllocation(Counter& counter, long long size) {
+    counter.count.fetch_add(1, std::memory_order_relaxed);
+    counter.bytes.fetch_add(size, std::memory_order_relaxed);
+    long long live = counter.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    long long peak = counter.peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !counter.peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void resetCounter(Counter& counter) {
+    counter.count = 0;
+    counter.bytes = 0;
+    counter.liveBytes = 0;
+    counter.peakLiveBytes = 0;
+}
+
+AllocStats snapshot(const Counter& counter) {
+    AllocStats stats;
+    stats.count = counter.count.load(std::memory_order_relaxed);
+    stats.bytes = counter.bytes.load(std::memory_order_relaxed);
+    stats.liveBytes = counter.liveBytes.load(std::memory_order_relaxed);
+    stats.peakLiveBytes = counter.peakLiveBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void reportRow(OutputBuffer& out, const char* name, const AllocStats& stats) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-14s %12lld %14lld %14lld\n", name, stats.count, stats.bytes, stats.peakLiveBytes);
+    out.append(line);
+}
+
+}
+
+namespace {
+
+struct alignas(alignof(std::max_align_t)) AllocHeader {
+    size_t size;
+    unsigned char phase;
+    unsigned char category;
+};
+
+std::atomic<bool> trackingAvailable(false);
+
+}
+
+void* AllocTracker::allocate(size_t size) noexcept {
+    void* block = std::malloc(sizeof(AllocHeader) + (size == 0 ? 1 : size));
+    if (block == nullptr) {
+        return nullptr;
+    }
+    AllocHeader* header = static_cast<AllocHeader*>(block);
+    header->size = size;
+    header->phase = UNTRACKED;
+    header->category = UNTRACKED;
+    if (trackingEnabled.load(std::memory_order_relaxed)) {
+        header->phase = currentPhase;
+        header->category = currentCategory;
+        long long bytes = static_cast<long long>(size);
+        addAllocation(phaseCounters[header->phase], bytes);
+        addAllocation(categoryCounters[header->category], bytes);
+        addAllocation(totalCounter, bytes);
+    }
+    return header + 1;
+}
+
+void AllocTracker::deallocate(void* pointer) noexcept {
+    if (pointer == nullptr) {
+        return;
+    }
+    AllocHeader* header = static_cast<AllocHeader*>(pointer) - 1;
+    if (header->phase != UNTRACKED) {
+        long long bytes = static_cast<long long>(header->size);
+        phaseCounters[header->phase].liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        categoryCounters[header->category].liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        totalCounter.liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+    std::free(header);
+}
+
+void AllocTracker::setAvailable() {
+    trackingAvailable.store(true, std::memory_order_relaxed);
+}
+
+bool AllocTracker::available() {
+    return trackingAvailable.load(std::memory_order_relaxed);
+}
+
+void AllocTracker::setEnabled(bool enabled) {
+    trackingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool AllocTracker::enabled() {
+    return trackingEnabled.load(std::memory_order_relaxed);
+}
+
+void AllocTracker::reset() {
+    for (Counter& counter : phaseCounters) {
+        resetCounter(counter);
+    }
+    for (Counter& counter : categoryCounters) {
+        resetCounter(counter);
+    }
+    resetCounter(totalCounter);
+}
+
+void AllocTracker::resetPeaks() {
+    for (Counter& counter : phaseCounters) {
+        counter.peakLiveBytes = counter.liveBytes.load(std::memory_order_relaxed);
+    }
+    for (Counter& counter : categoryCounters) {
+        counter.peakLiveBytes = counter.liveBytes.load(std::memory_order_relaxed);
+    }
+    totalCounter.peakLiveBytes = totalCounter.liveBytes.load(std::memory_order_relaxed);
+}
+
+AllocStats AllocTracker::phaseStats(AllocPhase phase) {
+    return snapshot(phaseCounters[static_cast<int>(phase)]);
+}
+
+AllocStats AllocTracker::categoryStats(AllocCategory category) {
+    return snapshot(categoryCounters[static_cast<int>(category)]);
+}
+
+AllocStats AllocTracker::totalStats() {
+    return snapshot(totalCounter);
+}
+
+const char* AllocTracker::phaseName(AllocPhase phase) {
+    return phaseNames[static_cast<int>(phase)];
+}
+
+void AllocTracker::report(OutputBuffer& out) {
+    out.append("\n=== ALLOCATIONS ===\n");
+    if (!available()) {
+        out.append("allocation tracking is not linked in (build allocnew.cpp with YMP_ALLOC_TRACKING)\n");
+        return;
+    }
+    char header[128];
+    std::snprintf(header, sizeof(header), "%-14s %12s %14s %14s\n", "phase", "count", "bytes", "peak live");
+    out.append(header);
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        reportRow(out, phaseNames[i], snapshot(phaseCounters[i]));
+    }
+    std::snprintf(header, sizeof(header), "%-14s %12s %14s %14s\n", "structure", "count", "bytes", "peak live");
+    out.append(header);
+    for (int i = 0; i < CATEGORY_COUNT; i++) {
+        reportRow(out, categoryNames[i], snapshot(categoryCounters[i]));
+    }
+    reportRow(out, "total", snapshot(totalCounter));
+}
+
+AllocPhaseScope::AllocPhaseScope(AllocPhase phase) : previous(currentPhase) {
+    currentPhase = static_cast<unsigned char>(phase);
+}
+
+AllocPhaseScope::~AllocPhaseScope() {
+    currentPhase = previous;
+}
+
+AllocCategoryScope::AllocCategoryScope(AllocCategory category) : previous(currentCategory) {
+    currentCategory = static_cast<unsigned char>(category);
+}
+
+AllocCategoryScope::~AllocCategoryScope() {
+    currentCategory = previous;
+}
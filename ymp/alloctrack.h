@@ -0,0 +1,74 @@
+#ifndef ALLOCTRACK_H
+#define ALLOCTRACK_H
+
+#include "output.h"
+#include <cstddef>
+
+enum class AllocPhase {
+    OTHER,
+    LEXER,
+    PARSER,
+    SEMANTIC,
+    IR,
+    EMIT,
+    CODEGEN,
+    COUNT
+};
+
+enum class AllocCategory {
+    OTHER,
+    TOKENS,
+    PARSE_TREE,
+    SYMBOL_TABLE,
+    LEXEME_TABLE,
+    DIAGNOSTICS,
+    IR,
+    OUTPUT,
+    COUNT
+};
+
+struct AllocStats {
+    long long count;
+    long long bytes;
+    long long liveBytes;
+    long long peakLiveBytes;
+};
+
+class AllocTracker {
+public:
+    static void* allocate(size_t size) noexcept;
+    static void deallocate(void* pointer) noexcept;
+    static void setAvailable();
+    static bool available();
+    static void setEnabled(bool enabled);
+    static bool enabled();
+    static void reset();
+    static void resetPeaks();
+    static AllocStats phaseStats(AllocPhase phase);
+    static AllocStats categoryStats(AllocCategory category);
+    static AllocStats totalStats();
+    static const char* phaseName(AllocPhase phase);
+    static void report(OutputBuffer& out);
+};
+
+class AllocPhaseScope {
+private:
+    unsigned char previous;
+public:
+    AllocPhaseScope(AllocPhase phase);
+    AllocPhaseScope(const AllocPhaseScope&) = delete;
+    AllocPhaseScope& operator=(const AllocPhaseScope&) = delete;
+    ~AllocPhaseScope();
+};
+
+class AllocCategoryScope {
+private:
+    unsigned char previous;
+public:
+    AllocCategoryScope(AllocCategory category);
+    AllocCategoryScope(const AllocCategoryScope&) = delete;
+    AllocCategoryScope& operator=(const AllocCategoryScope&) = delete;
+    ~AllocCategoryScope();
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include "asyncwriter.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <utility>
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+AsyncWriter::AsyncWriter(size_t pending)
+    : maxPending(pending == 0 ? 1 : pending), active(0), failures(0), stopping(false) {
+    thread = std::thread(&AsyncWriter::run, this);
+}
+
+AsyncWriter::~AsyncWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    thread.join();
+}
+
+std::string AsyncWriter::acquireBuffer() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (freeBuffers.empty()) {
+        return std::string();
+    }
+    std::string buffer = std::move(freeBuffers.back());
+    freeBuffers.pop_back();
+    return buffer;
+}
+
+void AsyncWriter::enqueue(Job&& job) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        jobDone.wait(lock, [this] { return jobs.size() + active < maxPending; });
+        jobs.push_back(std::move(job));
+    }
+    jobReady.notify_one();
+}
+
+void AsyncWriter::writeFile(const std::string& path, std::string&& contents) {
+    enqueue(Job{ -1, path, std::move(contents), true });
+}
+
+// Takes the bytes of contents and leaves an empty recycled buffer in its place,
+// so a caller that refills the same string does not start from zero capacity.
+void AsyncWriter::writeFileFrom(const std::string& path, std::string& contents) {
+    std::string data = acquireBuffer();
+    data.swap(contents);
+    writeFile(path, std::move(data));
+}
+
+void AsyncWriter::write(int fd, std::string&& chunk) {
+    enqueue(Job{ fd, std::string(), std::move(chunk), false });
+}
+
+void AsyncWriter::close(int fd) {
+    enqueue(Job{ fd, std::string(), std::string(), true });
+}
+
+void AsyncWriter::drain() {
+    std::unique_lock<std::mutex> lock(mutex);
+    jobDone.wait(lock, [this] { return jobs.empty() && active == 0; });
+}
+
+size_t AsyncWriter::failed() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failures;
+}
+
+void AsyncWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) {
+            return;
+        }
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        active++;
+        lock.unlock();
+        bool ok = perform(job);
+        job.data.clear();
+        lock.lock();
+        if (!ok) {
+            failures++;
+        }
+        if (job.data.capacity() > 0 && freeBuffers.size() < maxPending) {
+            freeBuffers.push_back(std::move(job.data));
+        }
+        active--;
+        jobDone.notify_all();
+    }
+}
+
+int AsyncWriter::openForWrite(const std::string& path) {
+#ifdef _WIN32
+    return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644);
+#endif
+}
+
+bool AsyncWriter::perform(Job& job) {
+    int fd = job.fd;
+    if (fd < 0) {
+        fd = openForWrite(job.path);
+        if (fd < 0) {
+            return false;
+        }
+    }
+    bool ok = writeAll(fd, job.data.data(), job.data.size());
+    if (job.closeAfter) {
+#ifdef _WIN32
+        ok = _close(fd) == 0 && ok;
+#else
+        ok = ::close(fd) == 0 && ok;
+#endif
+    }
+    return ok;
+}
+
+bool AsyncWriter::writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        int written = _write(fd, data, static_cast<unsigned int>(size));
+#else
+        ssize_t written = ::write(fd, data, size);
+#endif
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+AsyncSink::AsyncSink(AsyncWriter& w, int f) : writer(w), fd(f), chunk(w.acquireBuffer()) {
+}
+
+AsyncSink::~AsyncSink() {
+    flush();
+}
+
+void AsyncSink::write(const char* data, size_t size) {
+    chunk.append(data, size);
+    if (chunk.size() >= CHUNK_SIZE) {
+        flush();
+    }
+}
+
+void AsyncSink::flush() {
+    if (chunk.empty()) {
+        return;
+    }
+    writer.write(fd, std::move(chunk));
+    chunk = writer.acquireBuffer();
+}
@@ -0,0 +1,66 @@
+#ifndef ASYNCWRITER_H
+#define ASYNCWRITER_H
+
+#include "output.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class AsyncWriter {
+private:
+    struct Job {
+        int fd;
+        std::string path;
+        std::string data;
+        bool closeAfter;
+    };
+    static const size_t DEFAULT_MAX_PENDING = 3;
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    std::deque<Job> jobs;
+    std::vector<std::string> freeBuffers;
+    size_t maxPending;
+    size_t active;
+    size_t failures;
+    bool stopping;
+    std::thread thread;
+    void enqueue(Job&& job);
+    void run();
+    bool perform(Job& job);
+    bool writeAll(int fd, const char* data, size_t size);
+public:
+    AsyncWriter(size_t pending = DEFAULT_MAX_PENDING);
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+    ~AsyncWriter();
+    static int openForWrite(const std::string& path);
+    std::string acquireBuffer();
+    void writeFile(const std::string& path, std::string&& contents);
+    void writeFileFrom(const std::string& path, std::string& contents);
+    void write(int fd, std::string&& chunk);
+    void close(int fd);
+    void drain();
+    size_t failed();
+};
+
+class AsyncSink : public OutputSink {
+private:
+    static const size_t CHUNK_SIZE = 256 * 1024;
+    AsyncWriter& writer;
+    int fd;
+    std::string chunk;
+public:
+    AsyncSink(AsyncWriter& w, int f);
+    AsyncSink(const AsyncSink&) = delete;
+    AsyncSink& operator=(const AsyncSink&) = delete;
+    ~AsyncSink();
+    void write(const char* data, size_t size) override;
+    void flush();
+};
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef ATTRIBUTES_H
+#define ATTRIBUTES_H
+
+// Keep work out of the frames of recursive descent functions: YMP_NOINLINE
+// for helpers on the normal path, YMP_COLD for diagnostics.
+#if defined(_MSC_VER)
+#define YMP_NOINLINE __declspec(noinline)
+#define YMP_COLD __declspec(noinline)
+#else
+#define YMP_NOINLINE __attribute__((noinline))
+#define YMP_COLD __attribute__((noinline, cold))
+#endif
+
+#endif
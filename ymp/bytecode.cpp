@@ -0,0 +1,331 @@
+#include "bytecode.h"
+
+Instruction::Instruction(OpCode o, int x, int l, int y) : op(o), operand(x), extra(y), line(l) {
+}
+
+BytecodeVariable::BytecodeVariable(const std::string& n, IrType t) : name(n), type(t) {
+}
+
+BytecodeStatement::BytecodeStatement(size_t f, size_t l, int ln) : first(f), last(l), line(ln) {
+}
+
+BytecodeProgram::BytecodeProgram() : returnType(IrType::INT_TYPE) {
+}
+
+BytecodeEmitter::BytecodeEmitter() : function(nullptr), program(nullptr) {
+}
+
+BytecodeProgram BytecodeEmitter::emit(const IrFunction& irFunction) {
+    BytecodeProgram result;
+    function = &irFunction;
+    program = &result;
+    result.name = irFunction.name;
+    result.returnType = irFunction.returnType;
+    for (const IrVariable& variable : irFunction.variables) {
+        result.variables.emplace_back(variable.name, variable.type);
+    }
+    tempDefs.assign(irFunction.tempCount, -1);
+    stringIds.assign(irFunction.literals.size(), -1);
+    for (size_t i = 0; i < irFunction.code.size(); i++) {
+        const IrInstr& instr = irFunction.code[i];
+        size_t first = result.code.size();
+        switch (instr.op) {
+        case IrOp::ADD:
+        case IrOp::SUB:
+        case IrOp::CONCAT:
+            tempDefs[instr.result] = static_cast<int>(i);
+            break;
+        case IrOp::DEF: {
+            int variable = irFunction.versions[instr.result].variable;
+            emitOperand(instr.a, instr.line);
+            OpCode op = irFunction.variables[variable].type == IrType::CHAR_TYPE ? OpCode::STORE_STR : OpCode::STORE_INT;
+            result.code.emplace_back(op, variable, instr.line);
+            endStatement(first, instr.line);
+            break;
+        }
+        case IrOp::RETURN:
+            emitOperand(instr.a, instr.line);
+            result.code.emplace_back(irFunction.returnType == IrType::CHAR_TYPE ? OpCode::RETURN_STR : OpCode::RETURN_INT, 0, instr.line);
+            endStatement(first, instr.line);
+            break;
+        }
+    }
+    function = nullptr;
+    program = nullptr;
+    return result;
+}
+
+void BytecodeEmitter::emitOperand(const IrOperand& operand, int line) {
+    switch (operand.kind) {
+    case IrOperandKind::VERSION: {
+        int variable = function->variableOf(operand);
+        OpCode op = function->variables[variable].type == IrType::CHAR_TYPE ? OpCode::LOAD_STR : OpCode::LOAD_INT;
+        program->code.emplace_back(op, variable, line);
+        break;
+    }
+    case IrOperandKind::INT_CONST:
+        program->code.emplace_back(OpCode::PUSH_INT, function->literals[operand.index].value, line);
+        break;
+    case IrOperandKind::STR_CONST:
+        if (stringIds[operand.index] < 0) {
+            stringIds[operand.index] = static_cast<int>(program->strings.size());
+            program->strings.emplace_back(function->literals[operand.index].text);
+        }
+        program->code.emplace_back(OpCode::PUSH_STR, stringIds[operand.index], line);
+        break;
+    case IrOperandKind::TEMP: {
+        const IrInstr& instr = function->code[tempDefs[operand.index]];
+        emitOperand(instr.a, line);
+        emitOperand(instr.b, line);
+        OpCode op = instr.op == IrOp::SUB ? OpCode::SUB : instr.op == IrOp::CONCAT ? OpCode::CONCAT : OpCode::ADD;
+        program->code.emplace_back(op, 0, line);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void BytecodeEmitter::endStatement(size_t first, int line) {
+    program->statements.emplace_back(first, program->code.size(), line);
+}
+
+BytecodeOptimizer::BytecodeOptimizer() : statementStart(0) {
+}
+
+void BytecodeOptimizer::run(BytecodeProgram& program) {
+    code.clear();
+    code.reserve(program.code.size());
+    statementStart = 0;
+    std::vector<size_t> starts(program.code.size() + 1, 0);
+    size_t statement = 0;
+    for (size_t pc = 0; pc < program.code.size(); pc++) {
+        bool startsStatement = false;
+        while (statement < program.statements.size() && program.statements[statement].first == pc) {
+            startsStatement = true;
+            statement++;
+        }
+        append(program.code[pc], startsStatement);
+        starts[pc + 1] = code.size();
+    }
+    for (BytecodeStatement& entry : program.statements) {
+        entry.first = starts[entry.first];
+        entry.last = starts[entry.last];
+    }
+    program.code.swap(code);
+    code.clear();
+}
+
+void BytecodeOptimizer::append(const Instruction& instr, bool startsStatement) {
+    size_t size = code.size();
+    if (startsStatement) {
+        statementStart = size;
+        if (size > 0 && (instr.op == OpCode::LOAD_INT || instr.op == OpCode::LOAD_STR)) {
+            Instruction& last = code.back();
+            if (last.operand == instr.operand && last.op == (instr.op == OpCode::LOAD_INT ? OpCode::STORE_INT : OpCode::STORE_STR)) {
+                last.op = instr.op == OpCode::LOAD_INT ? OpCode::STORE_KEEP_INT : OpCode::STORE_KEEP_STR;
+                return;
+            }
+            if (instr.op == OpCode::LOAD_INT && last.op == OpCode::STORE_CONST_INT && last.operand == instr.operand) {
+                code.emplace_back(OpCode::PUSH_INT, last.extra, instr.line);
+                return;
+            }
+        }
+        code.push_back(instr);
+        return;
+    }
+    size_t local = size - statementStart;
+    switch (instr.op) {
+    case OpCode::STORE_INT:
+    case OpCode::STORE_STR: {
+        OpCode push = instr.op == OpCode::STORE_INT ? OpCode::PUSH_INT : OpCode::PUSH_STR;
+        if (local >= 1 && code.back().op == push) {
+            Instruction& last = code.back();
+            last.extra = last.operand;
+            last.operand = instr.operand;
+            last.op = instr.op == OpCode::STORE_INT ? OpCode::STORE_CONST_INT : OpCode::STORE_CONST_STR;
+            return;
+        }
+        break;
+    }
+    case OpCode::ADD:
+        if (local >= 2 && code[size - 2].op == OpCode::LOAD_INT && code[size - 1].op == OpCode::LOAD_INT) {
+            code[size - 2].op = OpCode::ADD_VARS;
+            code[size - 2].extra = code[size - 1].operand;
+            code.pop_back();
+            return;
+        }
+        break;
+    case OpCode::CONCAT:
+        if (local >= 2 && code[size - 2].op == OpCode::CONCAT_N
+            && (code[size - 1].op == OpCode::PUSH_STR || code[size - 1].op == OpCode::LOAD_STR)) {
+            std::swap(code[size - 2], code[size - 1]);
+            code[size - 1].operand++;
+            return;
+        }
+        code.emplace_back(OpCode::CONCAT_N, 2, instr.line);
+        return;
+    default:
+        break;
+    }
+    code.push_back(instr);
+}
+
+const char* opCodeName(OpCode op) {
+    switch (op) {
+    case OpCode::PUSH_INT: return "PUSH_INT";
+    case OpCode::PUSH_STR: return "PUSH_STR";
+    case OpCode::LOAD_INT: return "LOAD_INT";
+    case OpCode::LOAD_STR: return "LOAD_STR";
+    case OpCode::STORE_INT: return "STORE_INT";
+    case OpCode::STORE_STR: return "STORE_STR";
+    case OpCode::ADD: return "ADD";
+    case OpCode::SUB: return "SUB";
+    case OpCode::CONCAT: return "CONCAT";
+    case OpCode::RETURN_INT: return "RETURN_INT";
+    case OpCode::RETURN_STR: return "RETURN_STR";
+    case OpCode::STORE_CONST_INT: return "STORE_CONST_INT";
+    case OpCode::STORE_CONST_STR: return "STORE_CONST_STR";
+    case OpCode::STORE_KEEP_INT: return "STORE_KEEP_INT";
+    case OpCode::STORE_KEEP_STR: return "STORE_KEEP_STR";
+    case OpCode::ADD_VARS: return "ADD_VARS";
+    case OpCode::CONCAT_N: return "CONCAT_N";
+    }
+    return "?";
+}
+
+void appendInstructionText(const BytecodeProgram& program, const Instruction& instr, OutputBuffer& out) {
+    switch (instr.op) {
+    case OpCode::PUSH_INT:
+        out.appendInt(instr.operand);
+        break;
+    case OpCode::PUSH_STR:
+        out.put('"');
+        out.append(program.strings[instr.operand]);
+        out.put('"');
+        break;
+    case OpCode::LOAD_INT:
+    case OpCode::LOAD_STR:
+        out.append(program.variables[instr.operand].name);
+        break;
+    case OpCode::STORE_INT:
+    case OpCode::STORE_STR:
+    case OpCode::STORE_KEEP_INT:
+    case OpCode::STORE_KEEP_STR:
+        out.append(program.variables[instr.operand].name);
+        out.append(" =");
+        break;
+    case OpCode::STORE_CONST_INT:
+        out.appendInt(instr.extra);
+        out.put(' ');
+        out.append(program.variables[instr.operand].name);
+        out.append(" =");
+        break;
+    case OpCode::STORE_CONST_STR:
+        out.put('"');
+        out.append(program.strings[instr.extra]);
+        out.append("\" ");
+        out.append(program.variables[instr.operand].name);
+        out.append(" =");
+        break;
+    case OpCode::ADD:
+    case OpCode::CONCAT:
+        out.put('+');
+        break;
+    case OpCode::ADD_VARS:
+        out.append(program.variables[instr.operand].name);
+        out.put(' ');
+        out.append(program.variables[instr.extra].name);
+        out.append(" +");
+        break;
+    case OpCode::CONCAT_N:
+        for (int i = 1; i < instr.operand; i++) {
+            if (i != 1) {
+                out.put(' ');
+            }
+            out.put('+');
+        }
+        break;
+    case OpCode::SUB:
+        out.put('-');
+        break;
+    case OpCode::RETURN_INT:
+    case OpCode::RETURN_STR:
+        out.append("RETURN");
+        break;
+    }
+}
+
+void appendStatementText(const BytecodeProgram& program, const BytecodeStatement& statement, OutputBuffer& out) {
+    if (statement.first > 0 && statement.first < statement.last) {
+        const Instruction& previous = program.code[statement.first - 1];
+        if (previous.op == OpCode::STORE_KEEP_INT || previous.op == OpCode::STORE_KEEP_STR) {
+            out.append(program.variables[previous.operand].name);
+            out.put(' ');
+        }
+    }
+    for (size_t pc = statement.first; pc < statement.last; pc++) {
+        if (pc != statement.first) {
+            out.put(' ');
+        }
+        appendInstructionText(program, program.code[pc], out);
+    }
+}
+
+void appendInstruction(const BytecodeProgram& program, const Instruction& instr, OutputBuffer& out) {
+    out.append(opCodeName(instr.op));
+    switch (instr.op) {
+    case OpCode::PUSH_INT:
+    case OpCode::PUSH_STR:
+    case OpCode::LOAD_INT:
+    case OpCode::LOAD_STR:
+        out.put(' ');
+        appendInstructionText(program, instr, out);
+        break;
+    case OpCode::STORE_INT:
+    case OpCode::STORE_STR:
+    case OpCode::STORE_KEEP_INT:
+    case OpCode::STORE_KEEP_STR:
+        out.put(' ');
+        out.append(program.variables[instr.operand].name);
+        break;
+    case OpCode::STORE_CONST_INT:
+        out.put(' ');
+        out.append(program.variables[instr.operand].name);
+        out.put(' ');
+        out.appendInt(instr.extra);
+        break;
+    case OpCode::STORE_CONST_STR:
+        out.put(' ');
+        out.append(program.variables[instr.operand].name);
+        out.append(" \"");
+        out.append(program.strings[instr.extra]);
+        out.put('"');
+        break;
+    case OpCode::ADD_VARS:
+        out.put(' ');
+        out.append(program.variables[instr.operand].name);
+        out.put(' ');
+        out.append(program.variables[instr.extra].name);
+        break;
+    case OpCode::CONCAT_N:
+        out.put(' ');
+        out.appendInt(instr.operand);
+        break;
+    default:
+        break;
+    }
+}
+
+void disassemble(const BytecodeProgram& program, OutputBuffer& out) {
+    out.append("\n=== BYTECODE ===\n");
+    for (size_t pc = 0; pc < program.code.size(); pc++) {
+        const Instruction& instr = program.code[pc];
+        out.appendInt(static_cast<long long>(pc));
+        out.append(": ");
+        appendInstruction(program, instr, out);
+        out.append("    ; line ");
+        out.appendInt(instr.line);
+        out.put('\n');
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include "ir.h"
+#include "output.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class OpCode : unsigned char {
+    PUSH_INT,
+    PUSH_STR,
+    LOAD_INT,
+    LOAD_STR,
+    STORE_INT,
+    STORE_STR,
+    ADD,
+    SUB,
+    CONCAT,
+    RETURN_INT,
+    RETURN_STR,
+    STORE_CONST_INT,
+    STORE_CONST_STR,
+    STORE_KEEP_INT,
+    STORE_KEEP_STR,
+    ADD_VARS,
+    CONCAT_N
+};
+
+struct Instruction {
+    OpCode op;
+    int operand;
+    int extra;
+    int line;
+    Instruction(OpCode o, int x, int l, int y = 0);
+};
+
+struct BytecodeVariable {
+    std::string name;
+    IrType type;
+    BytecodeVariable(const std::string& n, IrType t);
+};
+
+struct BytecodeStatement {
+    size_t first;
+    size_t last;
+    int line;
+    BytecodeStatement(size_t f, size_t l, int ln);
+};
+
+struct BytecodeProgram {
+    std::string name;
+    IrType returnType;
+    std::vector<BytecodeVariable> variables;
+    std::vector<std::string> strings;
+    std::vector<Instruction> code;
+    std::vector<BytecodeStatement> statements;
+    BytecodeProgram();
+};
+
+class BytecodeEmitter {
+private:
+    const IrFunction* function;
+    BytecodeProgram* program;
+    std::vector<int> tempDefs;
+    std::vector<int> stringIds;
+    void emitOperand(const IrOperand& operand, int line);
+    void endStatement(size_t first, int line);
+public:
+    BytecodeEmitter();
+    BytecodeProgram emit(const IrFunction& irFunction);
+};
+
+class BytecodeOptimizer {
+private:
+    std::vector<Instruction> code;
+    size_t statementStart;
+    void append(const Instruction& instr, bool startsStatement);
+public:
+    BytecodeOptimizer();
+    void run(BytecodeProgram& program);
+};
+
+const char* opCodeName(OpCode op);
+void appendInstructionText(const BytecodeProgram& program, const Instruction& instr, OutputBuffer& out);
+void appendInstruction(const BytecodeProgram& program, const Instruction& instr, OutputBuffer& out);
+void appendStatementText(const BytecodeProgram& program, const BytecodeStatement& statement, OutputBuffer& out);
+void disassemble(const BytecodeProgram& program, OutputBuffer& out);
+
+#endif
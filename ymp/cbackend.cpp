@@ -0,0 +1,326 @@
+#include "cbackend.h"
+#include "alloctrack.h"
+#include <sstream>
+
+CBackend::CBackend(OutputBuffer& o) : out(o), returnType(CValueType::INT_VALUE) {
+}
+
+void CBackend::addError(const std::string& message, int line) {
+    AllocCategoryScope allocCategory(AllocCategory::DIAGNOSTICS);
+    std::stringstream ss;
+    ss << "Codegen error at line " << line << ": " << message;
+    errors.push_back(ss.str());
+}
+
+bool CBackend::hasErrors() const {
+    return !errors.empty();
+}
+
+const std::vector<std::string>& CBackend::getErrors() const {
+    return errors;
+}
+
+bool CBackend::generate(const std::shared_ptr<ParseTreeNode>& root, bool withDriver) {
+    errors.clear();
+    variables.clear();
+    variableOrder.clear();
+    if (!root || root->name != "Function" || root->children.size() < 4) {
+        addError("expected an analyzed function", root ? root->line : 0);
+        return false;
+    }
+    const ParseTreeNode& beginNode = *root->children[0];
+    returnType = CValueType::INT_VALUE;
+    functionName = "main";
+    if (beginNode.children.size() >= 2) {
+        const ParseTreeNode& typeNode = *beginNode.children[0];
+        if (!typeNode.children.empty() && typeNode.children[0]->token.type == TokenType::CHAR) {
+            returnType = CValueType::CHAR_VALUE;
+        }
+        const ParseTreeNode& nameNode = *beginNode.children[1];
+        if (!nameNode.children.empty()) {
+            functionName = nameNode.children[0]->token.value;
+        }
+    }
+    collectDeclarations(*root->children[1]);
+
+    emitRuntime();
+    out.append(returnType == CValueType::CHAR_VALUE ? "char* ymp_" : "int ymp_");
+    out.append(functionName);
+    out.append("(void) {\n");
+    emitDeclarations();
+    for (const auto& op : root->children[2]->children) {
+        if (op->name == "Op") {
+            emitOp(*op);
+        }
+    }
+    emitEnd(*root->children[3]);
+    out.append("}\n");
+    if (withDriver) {
+        emitDriver();
+    }
+    out.flush();
+    return !hasErrors();
+}
+
+void CBackend::emitRuntime() {
+    out.append(
+        "#include <stdarg.h>\n"
+        "#include <stdio.h>\n"
+        "#include <stdlib.h>\n"
+        "#include <string.h>\n"
+        "\n"
+        "static char* ymp_concat(int count, ...) {\n"
+        "    va_list args;\n"
+        "    size_t size = 0;\n"
+        "    int i;\n"
+        "    char* result;\n"
+        "    char* p;\n"
+        "    va_start(args, count);\n"
+        "    for (i = 0; i < count; i++) {\n"
+        "        const char* part = va_arg(args, const char*);\n"
+        "        if (part != NULL) size += strlen(part);\n"
+        "    }\n"
+        "    va_end(args);\n"
+        "    result = (char*)malloc(size + 1);\n"
+        "    if (result == NULL) abort();\n"
+        "    p = result;\n"
+        "    va_start(args, count);\n"
+        "    for (i = 0; i < count; i++) {\n"
+        "        const char* part = va_arg(args, const char*);\n"
+        "        if (part != NULL) {\n"
+        "            size_t length = strlen(part);\n"
+        "            memcpy(p, part, length);\n"
+        "            p += length;\n"
+        "        }\n"
+        "    }\n"
+        "    va_end(args);\n"
+        "    *p = '\\0';\n"
+        "    return result;\n"
+        "}\n"
+        "\n"
+        "static void ymp_set(char** target, char* value) {\n"
+        "    free(*target);\n"
+        "    *target = value;\n"
+        "}\n"
+        "\n");
+}
+
+void CBackend::emitName(const std::string& name) {
+    out.append("v_");
+    out.append(name);
+}
+
+void CBackend::emitStringLiteral(std::string_view contents) {
+    out.put('"');
+    for (char ch : contents) {
+        unsigned char c = static_cast<unsigned char>(ch);
+        if (c == '\\' || c == '"' || c == '?') {
+            out.put('\\');
+            out.put(static_cast<char>(c));
+        }
+        else if (c < 0x20 || c >= 0x7f) {
+            out.put('\\');
+            out.put(static_cast<char>('0' + ((c >> 6) & 7)));
+            out.put(static_cast<char>('0' + ((c >> 3) & 7)));
+            out.put(static_cast<char>('0' + (c & 7)));
+        }
+        else {
+            out.put(static_cast<char>(c));
+        }
+    }
+    out.put('"');
+}
+
+void CBackend::collectDeclarations(const ParseTreeNode& descNode) {
+    for (const auto& descr : descNode.children) {
+        if (descr->name != "Descr" || descr->children.size() < 2) continue;
+        const ParseTreeNode& typeNode = *descr->children[0];
+        CValueType type = CValueType::INT_VALUE;
+        if (!typeNode.children.empty() && typeNode.children[0]->token.type == TokenType::CHAR) {
+            type = CValueType::CHAR_VALUE;
+        }
+        for (const auto& var : descr->children[1]->children) {
+            if (var->name == "Id" && variables.emplace(var->token.value, type).second && omittedVariables.count(var->token.value) == 0) {
+                variableOrder.push_back(var->token.value);
+            }
+        }
+    }
+}
+
+void CBackend::omitVariable(const std::string& name) {
+    omittedVariables.insert(name);
+}
+
+void CBackend::emitDeclarations() {
+    for (const auto& name : variableOrder) {
+        if (variables[name] == CValueType::CHAR_VALUE) {
+            out.append("    char* ");
+            emitName(name);
+            out.append(" = NULL;\n");
+        }
+        else {
+            out.append("    int ");
+            emitName(name);
+            out.append(" = 0;\n");
+        }
+    }
+}
+
+void CBackend::emitOp(const ParseTreeNode& opNode) {
+    if (opNode.children.size() < 2 || opNode.children[0]->name != "Id") return;
+    const Token& target = opNode.children[0]->token;
+    auto it = variables.find(target.value);
+    if (it == variables.end()) {
+        addError("Undeclared variable '" + target.value + "'", target.line);
+        return;
+    }
+    const ParseTreeNode& exprNode = *opNode.children[1];
+    if (!exprNode.code || exprNode.code->ops.empty()) {
+        addError("missing expression", target.line);
+        return;
+    }
+    const ExprCode& code = *exprNode.code;
+    if (it->second == CValueType::CHAR_VALUE) {
+        emitStringAssignment(target.value, code);
+        return;
+    }
+    subtreeStart.resize(code.ops.size());
+    for (size_t i = 0; i < code.ops.size(); i++) {
+        const ExprOp& op = code.ops[i];
+        bool binary = op.kind == ExprOpKind::ADD || op.kind == ExprOpKind::SUB;
+        subtreeStart[i] = binary ? subtreeStart[subtreeStart[i - 1] - 1] : static_cast<int>(i);
+    }
+    out.append("    ");
+    emitName(target.value);
+    out.append(" = (int)(");
+    emitIntExpr(code, static_cast<int>(code.ops.size()) - 1);
+    out.append(");\n");
+}
+
+void CBackend::emitIntOperand(const ExprCode& code, const ExprOp& op) {
+    if (op.kind == ExprOpKind::ID) {
+        const std::string& name = code.text(op);
+        auto it = variables.find(name);
+        if (it == variables.end() || it->second != CValueType::INT_VALUE) {
+            addError("Variable '" + name + "' is not an int", op.line);
+        }
+        out.append("(unsigned)");
+        emitName(name);
+    }
+    else if (op.kind == ExprOpKind::CONST) {
+        out.appendInt(op.value);
+        out.put('u');
+    }
+    else {
+        addError("unexpected operand in int expression", op.line);
+    }
+}
+
+// Emits the postorder subtree that ends at ops[end]. Operators along the left
+// spine print without parentheses because C is left-associative as well, so
+// only a compound right operand recurses.
+void CBackend::emitIntExpr(const ExprCode& code, int end) {
+    std::vector<int> spine;
+    int node = end;
+    while (code.ops[node].kind == ExprOpKind::ADD || code.ops[node].kind == ExprOpKind::SUB) {
+        spine.push_back(node);
+        node = subtreeStart[node - 1] - 1;
+    }
+    emitIntOperand(code, code.ops[node]);
+    for (auto it = spine.rbegin(); it != spine.rend(); ++it) {
+        out.append(code.ops[*it].kind == ExprOpKind::SUB ? " - " : " + ");
+        int right = *it - 1;
+        if (subtreeStart[right] == right) {
+            emitIntOperand(code, code.ops[right]);
+        }
+        else {
+            out.put('(');
+            emitIntExpr(code, right);
+            out.put(')');
+        }
+    }
+}
+
+void CBackend::emitStringAssignment(const std::string& target, const ExprCode& code) {
+    size_t termCount = 0;
+    for (const ExprOp& op : code.ops) {
+        if (op.kind == ExprOpKind::SUB) {
+            addError("operator '-' is not defined for char values", op.line);
+        }
+        else if (op.kind != ExprOpKind::ADD) {
+            termCount++;
+        }
+    }
+    out.append("    ymp_set(&");
+    emitName(target);
+    out.append(", ymp_concat(");
+    out.appendInt(static_cast<long long>(termCount));
+    for (const ExprOp& op : code.ops) {
+        if (op.kind == ExprOpKind::ADD || op.kind == ExprOpKind::SUB) {
+            continue;
+        }
+        out.append(", ");
+        if (op.kind == ExprOpKind::STRING) {
+            emitStringLiteral(code.text(op));
+        }
+        else if (op.kind == ExprOpKind::ID) {
+            const std::string& name = code.text(op);
+            auto it = variables.find(name);
+            if (it == variables.end() || it->second != CValueType::CHAR_VALUE) {
+                addError("Variable '" + name + "' is not a char", op.line);
+            }
+            out.append("(const char*)");
+            emitName(name);
+        }
+        else {
+            addError("unexpected operand in char expression", op.line);
+        }
+    }
+    out.append("));\n");
+}
+
+void CBackend::emitEnd(const ParseTreeNode& endNode) {
+    if (endNode.children.empty() || endNode.children[0]->name != "Id") {
+        addError("missing return value", endNode.line);
+        return;
+    }
+    const Token& value = endNode.children[0]->token;
+    auto it = variables.find(value.value);
+    if (it == variables.end()) {
+        addError("Undeclared variable '" + value.value + "' in return statement", value.line);
+        return;
+    }
+    if (returnType == CValueType::CHAR_VALUE) {
+        out.append("    {\n        char* result = ymp_concat(1, (const char*)");
+        emitName(value.value);
+        out.append(");\n");
+    }
+    else {
+        out.append("    {\n        int result = ");
+        emitName(value.value);
+        out.append(";\n");
+    }
+    for (const auto& name : variableOrder) {
+        if (variables[name] == CValueType::CHAR_VALUE) {
+            out.append("        free(");
+            emitName(name);
+            out.append(");\n");
+        }
+    }
+    out.append("        return result;\n    }\n");
+}
+
+void CBackend::emitDriver() {
+    out.append("\n#ifndef YMP_NO_MAIN\nint main(void) {\n");
+    if (returnType == CValueType::CHAR_VALUE) {
+        out.append("    char* result = ymp_");
+        out.append(functionName);
+        out.append("();\n    printf(\"%s\\n\", result);\n    free(result);\n");
+    }
+    else {
+        out.append("    printf(\"%d\\n\", ymp_");
+        out.append(functionName);
+        out.append("());\n");
+    }
+    out.append("    return 0;\n}\n#endif\n");
+}
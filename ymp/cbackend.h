@@ -0,0 +1,48 @@
+#ifndef CBACKEND_H
+#define CBACKEND_H
+
+#include "parser.h"
+#include "output.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+enum class CValueType {
+    INT_VALUE,
+    CHAR_VALUE
+};
+
+class CBackend {
+private:
+    OutputBuffer& out;
+    std::vector<std::string> errors;
+    std::unordered_map<std::string, CValueType> variables;
+    std::vector<std::string> variableOrder;
+    std::unordered_set<std::string> omittedVariables;
+    CValueType returnType;
+    std::string functionName;
+    std::vector<int> subtreeStart;
+    void addError(const std::string& message, int line);
+    void emitRuntime();
+    void emitName(const std::string& name);
+    void emitStringLiteral(std::string_view contents);
+    void collectDeclarations(const ParseTreeNode& descNode);
+    void emitDeclarations();
+    void emitOp(const ParseTreeNode& opNode);
+    void emitIntOperand(const ExprCode& code, const ExprOp& op);
+    void emitIntExpr(const ExprCode& code, int end);
+    void emitStringAssignment(const std::string& target, const ExprCode& code);
+    void emitEnd(const ParseTreeNode& endNode);
+    void emitDriver();
+public:
+    CBackend(OutputBuffer& o);
+    void omitVariable(const std::string& name);
+    bool generate(const std::shared_ptr<ParseTreeNode>& root, bool withDriver = true);
+    bool hasErrors() const;
+    const std::vector<std::string>& getErrors() const;
+};
+
+#endif
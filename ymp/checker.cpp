@@ -0,0 +1,445 @@
+#include "checker.h"
+#include "alloctrack.h"
+#include "trace.h"
+#include <algorithm>
+
+Checker::Checker(Lexer& l)
+    : tokens(l), functionReturnType(SymbolType::UNDEFINED), maxErrors(DEFAULT_MAX_ERRORS),
+    maxSemanticErrors(DEFAULT_MAX_ERRORS), suppressCascades(true), recovering(false), aborted(false),
+    exprNesting(0), exprTooDeep(false) {
+    nextToken();
+}
+
+void Checker::setMaxErrors(size_t limit) {
+    maxErrors = limit;
+    maxSemanticErrors = limit;
+}
+
+void Checker::setSuppressCascades(bool suppress) {
+    suppressCascades = suppress;
+}
+
+bool Checker::hasSyntaxErrors() const {
+    return !errors.empty();
+}
+
+bool Checker::hasSemanticErrors() const {
+    return !semanticErrors.empty();
+}
+
+const std::vector<std::string>& Checker::getSyntaxErrors() const {
+    return errors;
+}
+
+const std::vector<std::string>& Checker::getSemanticErrors() const {
+    return semanticErrors;
+}
+
+void Checker::nextToken() {
+    if (aborted) {
+        currentToken.type = TokenType::END_OF_FILE;
+        currentToken.value.clear();
+        return;
+    }
+    tokens.next(currentToken);
+}
+
+void Checker::error(const std::string& message) {
+    if (aborted || (suppressCascades && recovering)) {
+        return;
+    }
+    AllocCategoryScope allocCategory(AllocCategory::DIAGNOSTICS);
+    recovering = true;
+    errors.push_back("Syntax error at line " + std::to_string(currentToken.line) + ", position " + std::to_string(currentToken.position) + ": " + message);
+    if (maxErrors != 0 && errors.size() >= maxErrors) {
+        errors.push_back("too many errors, stopping");
+        aborted = true;
+        currentToken.type = TokenType::END_OF_FILE;
+        currentToken.value.clear();
+    }
+}
+
+void Checker::semanticError(const std::string& message, int line) {
+    if (!errors.empty() || (maxSemanticErrors != 0 && semanticErrors.size() >= maxSemanticErrors)) {
+        return;
+    }
+    AllocCategoryScope allocCategory(AllocCategory::DIAGNOSTICS);
+    semanticErrors.push_back("Semantic error at line " + std::to_string(line) + ": " + message);
+    if (maxSemanticErrors != 0 && semanticErrors.size() == maxSemanticErrors) {
+        semanticErrors.push_back("too many errors, stopping");
+    }
+}
+
+// An identifier only restarts parsing when the next token is '=': one that
+// is part of the broken statement would otherwise be read as a new
+// assignment and report a second, cascading error.
+void Checker::synchronizeToStatementEnd() {
+    while (currentToken.type != TokenType::SEMICOLON && currentToken.type != TokenType::END_OF_FILE && currentToken.type != TokenType::RETURN && currentToken.type != TokenType::RBRACE
+        && (currentToken.type != TokenType::ID || tokens.peek().type != TokenType::ASSIGN)) {
+        nextToken();
+    }
+    if (currentToken.type == TokenType::SEMICOLON) {
+        nextToken();
+    }
+    recovering = false;
+}
+
+void Checker::match(TokenType expected) {
+    if (currentToken.type == expected) {
+        if (expected == TokenType::SEMICOLON || expected == TokenType::LBRACE || expected == TokenType::RBRACE) {
+            recovering = false;
+        }
+        nextToken();
+    }
+    else {
+        error("Expected " + Token(expected).getTypeString() + " but found '" + currentToken.excerpt() + "'");
+        if (expected == TokenType::SEMICOLON || expected == TokenType::RBRACE || expected == TokenType::RPAREN) {
+            synchronizeToStatementEnd();
+        }
+    }
+}
+
+bool Checker::check() {
+    checkBegin();
+    symbols.enterScope();
+    checkDescriptions();
+    checkOperators();
+    checkEnd();
+    symbols.exitScope();
+    if (!errors.empty()) {
+        semanticErrors.clear();
+    }
+    return errors.empty() && semanticErrors.empty();
+}
+
+SymbolType Checker::checkType() {
+    if (currentToken.type == TokenType::INT) {
+        match(TokenType::INT);
+        return SymbolType::INT_TYPE;
+    }
+    if (currentToken.type == TokenType::CHAR) {
+        match(TokenType::CHAR);
+        return SymbolType::CHAR_TYPE;
+    }
+    if (currentToken.type == TokenType::ID) {
+        error("Unknown type '" + currentToken.excerpt());
+        match(TokenType::ID);
+    }
+    else {
+        error("Expected type (int or char)");
+    }
+    return SymbolType::UNDEFINED;
+}
+
+void Checker::checkBegin() {
+    functionReturnType = checkType();
+    checkFunctionName();
+    match(TokenType::LPAREN);
+    match(TokenType::RPAREN);
+    match(TokenType::LBRACE);
+}
+
+void Checker::checkFunctionName() {
+    if (currentToken.type == TokenType::ID) {
+        if (symbols.lookup(currentToken.value) != nullptr) {
+            semanticError("Function '" + currentToken.value + "' already declared", currentToken.line);
+        }
+        else {
+            AllocCategoryScope allocCategory(AllocCategory::SYMBOL_TABLE);
+            symbols.declare(SymbolInfo(currentToken.value, SymbolType::FUNCTION_TYPE, currentToken.line, true));
+        }
+        match(TokenType::ID);
+    }
+    else {
+        error("Expected function name identifier");
+    }
+}
+
+void Checker::checkDescriptions() {
+    while (currentToken.type == TokenType::INT || currentToken.type == TokenType::CHAR) {
+        checkDescr();
+    }
+}
+
+void Checker::checkDescr() {
+    TraceScope scope("Descr", "statement", TraceLevel::STATEMENTS, "line", currentToken.line);
+    SymbolType type = checkType();
+    checkVarList(type);
+    match(TokenType::SEMICOLON);
+}
+
+void Checker::declare(SymbolType type) {
+    AllocCategoryScope allocCategory(AllocCategory::SYMBOL_TABLE);
+    const SymbolInfo* existing = symbols.lookup(currentToken.value);
+    if (existing != nullptr) {
+        std::string existingWhat = existing->isFunction ? "function" : "variable";
+        semanticError("'" + currentToken.value + "' already declared as " + existingWhat + " at line " + std::to_string(existing->line), currentToken.line);
+    }
+    else {
+        symbols.declare(SymbolInfo(currentToken.value, type, currentToken.line));
+    }
+}
+
+void Checker::checkVarList(SymbolType type) {
+    if (currentToken.type == TokenType::ID) {
+        declare(type);
+        match(TokenType::ID);
+    }
+    else {
+        error("Expected identifier in variable list");
+        return;
+    }
+    while (currentToken.type == TokenType::COMMA) {
+        match(TokenType::COMMA);
+        if (currentToken.type == TokenType::ID) {
+            declare(type);
+            match(TokenType::ID);
+        }
+        else {
+            error("Expected identifier after comma");
+        }
+    }
+}
+
+void Checker::checkOperators() {
+    while (currentToken.type == TokenType::ID ||
+        currentToken.type == TokenType::ASSIGN ||
+        currentToken.type == TokenType::RETURN) {
+        if (currentToken.type == TokenType::RETURN) {
+            break;
+        }
+        checkOp();
+        if (hasSyntaxErrors() && currentToken.type == TokenType::RETURN) {
+            break;
+        }
+    }
+}
+
+void Checker::checkOp() {
+    TraceScope scope("Op", "statement", TraceLevel::STATEMENTS, "line", currentToken.line);
+    if (currentToken.type == TokenType::ID) {
+        int line = currentToken.line;
+        const SymbolInfo* target = symbols.lookup(currentToken.value);
+        if (target == nullptr) {
+            semanticError("Undeclared variable '" + currentToken.value + "'", line);
+        }
+        match(TokenType::ID);
+        if (currentToken.type == TokenType::ASSIGN) {
+            match(TokenType::ASSIGN);
+            beginExpr();
+            if (currentToken.type == TokenType::CHAR_CONST) {
+                checkStringExpr();
+                if (target != nullptr && target->type == SymbolType::INT_TYPE) {
+                    semanticError("cannot assign char to int variable '" + target->name + "'", line);
+                }
+            }
+            else {
+                checkNumExpr(target, line);
+            }
+            if (hasSyntaxErrors()) {
+                synchronizeToStatementEnd();
+            }
+            else {
+                match(TokenType::SEMICOLON);
+            }
+        }
+        else {
+            error("Expected '=' in operator");
+            synchronizeToStatementEnd();
+        }
+    }
+    else {
+        error("Expected identifier at start of operator but found '" + currentToken.excerpt() + "'");
+        if (currentToken.type == TokenType::ASSIGN) {
+            error("Missing identifier before '='");
+            match(TokenType::ASSIGN);
+            beginExpr();
+            if (currentToken.type == TokenType::CHAR_CONST) {
+                checkStringExpr();
+            }
+            else {
+                checkNumExpr(nullptr, currentToken.line);
+            }
+            if (hasSyntaxErrors()) {
+                synchronizeToStatementEnd();
+            }
+            else {
+                match(TokenType::SEMICOLON);
+            }
+        }
+        else {
+            synchronizeToStatementEnd();
+        }
+    }
+}
+
+void Checker::beginExpr() {
+    exprHeights.clear();
+    exprNesting = 0;
+    exprTooDeep = false;
+}
+
+// Tracks the height of the operator tree the parser would build, so both
+// reject the same expressions at the same token.
+void Checker::exprOperand() {
+    exprHeights.push_back(0);
+}
+
+void Checker::exprOperator() {
+    if (exprHeights.size() < 2) {
+        return;
+    }
+    int right = exprHeights.back();
+    exprHeights.pop_back();
+    int height = std::max(exprHeights.back(), right) + 1;
+    exprHeights.back() = height;
+    if (height > MAX_EXPRESSION_DEPTH) {
+        expressionTooDeep();
+    }
+}
+
+void Checker::expressionTooDeep() {
+    if (exprTooDeep) {
+        return;
+    }
+    exprTooDeep = true;
+    error("Expression is nested more than " + std::to_string(MAX_EXPRESSION_DEPTH) + " levels deep");
+    while (currentToken.type != TokenType::SEMICOLON && currentToken.type != TokenType::END_OF_FILE && currentToken.type != TokenType::RETURN && currentToken.type != TokenType::RBRACE) {
+        nextToken();
+    }
+}
+
+void Checker::checkNumExpr(const SymbolInfo* target, int line) {
+    if (checkSimpleNumExpr(target, line)) {
+        while (currentToken.type == TokenType::PLUS || currentToken.type == TokenType::MINUS) {
+            bool isPlus = currentToken.type == TokenType::PLUS;
+            match(isPlus ? TokenType::PLUS : TokenType::MINUS);
+            if (!checkSimpleNumExpr(target, line)) {
+                error(isPlus ? "Missing operand after '+' operator" : "Missing operand after '-' operator");
+                break;
+            }
+            exprOperator();
+        }
+    }
+}
+
+bool Checker::checkSimpleNumExpr(const SymbolInfo* target, int line) {
+    if (currentToken.type == TokenType::ID) {
+        if (target != nullptr) {
+            const SymbolInfo* found = symbols.lookup(currentToken.value);
+            if (found == nullptr) {
+                semanticError("Undeclared variable '" + currentToken.value + "'", line);
+            }
+            else if (found->isFunction) {
+                semanticError("Cannot use function '" + currentToken.value + "' as a value", line);
+            }
+            else {
+                SymbolType targetType = target->type;
+                SymbolType valueType = found->type;
+                if (targetType == SymbolType::INT_TYPE && valueType == SymbolType::CHAR_TYPE) {
+                    semanticError("cannot assign char '" + currentToken.value + "' to int '" + target->name + "'", line);
+                }
+                else if (targetType == SymbolType::CHAR_TYPE && valueType == SymbolType::INT_TYPE) {
+                    semanticError("cannot assign int '" + currentToken.value + "' to char '" + target->name + "'", line);
+                }
+            }
+        }
+        exprOperand();
+        match(TokenType::ID);
+        return true;
+    }
+    else if (currentToken.type == TokenType::INT_NUM) {
+        if (currentToken.outOfRange) {
+            error("Integer constant '" + currentToken.excerpt() + "' is out of range");
+        }
+        if (target != nullptr && target->type == SymbolType::CHAR_TYPE) {
+            semanticError("cannot assign integer '" + currentToken.value + "' to char '" + target->name + "'", line);
+        }
+        exprOperand();
+        match(TokenType::INT_NUM);
+        return true;
+    }
+    else if (currentToken.type == TokenType::LPAREN) {
+        if (exprNesting == MAX_EXPRESSION_DEPTH) {
+            exprOperand();
+            expressionTooDeep();
+            return true;
+        }
+        match(TokenType::LPAREN);
+        exprNesting++;
+        checkNumExpr(target, line);
+        exprNesting--;
+        if (currentToken.type == TokenType::RPAREN) {
+            match(TokenType::RPAREN);
+        }
+        else if (!exprTooDeep) {
+            error("Expected ')' after expression");
+        }
+        return true;
+    }
+    else if (currentToken.type == TokenType::ERROR) {
+        exprOperand();
+        error("Invalid token '" + currentToken.excerpt() + "' in numeric expression");
+        match(TokenType::ERROR);
+        return false;
+    }
+    else {
+        error("Expected identifier, constant or '(' in numeric expression");
+        return false;
+    }
+}
+
+void Checker::checkStringExpr() {
+    checkSimpleStringExpr();
+    while (currentToken.type == TokenType::PLUS) {
+        match(TokenType::PLUS);
+        checkSimpleStringExpr();
+        exprOperator();
+    }
+}
+
+void Checker::checkSimpleStringExpr() {
+    if (currentToken.type == TokenType::CHAR_CONST) {
+        exprOperand();
+        match(TokenType::CHAR_CONST);
+    }
+    else if (currentToken.type == TokenType::ERROR) {
+        exprOperand();
+        error("Invalid token '" + currentToken.excerpt() + "' in string expression");
+        match(TokenType::ERROR);
+    }
+    else {
+        error("Expected string constant");
+    }
+}
+
+void Checker::checkEnd() {
+    if (currentToken.type == TokenType::RETURN) {
+        match(TokenType::RETURN);
+    }
+    else {
+        error("Expected RETURN but found '" + currentToken.excerpt() + "'");
+        return;
+    }
+    if (currentToken.type == TokenType::ID) {
+        int line = currentToken.line;
+        const SymbolInfo* found = symbols.lookup(currentToken.value);
+        if (found == nullptr) {
+            semanticError("Undeclared variable '" + currentToken.value + "' in return statement", line);
+        }
+        else if (found->isFunction) {
+            semanticError("Cannot return function '" + currentToken.value + "'", line);
+        }
+        else if (found->type != functionReturnType) {
+            std::string funcType = (functionReturnType == SymbolType::INT_TYPE) ? "int" : "char";
+            std::string varType = (found->type == SymbolType::INT_TYPE) ? "int" : "char";
+            semanticError("function returns " + funcType + " but variable is " + varType, line);
+        }
+        match(TokenType::ID);
+    }
+    else {
+        error("Expected identifier after return");
+    }
+    match(TokenType::SEMICOLON);
+    match(TokenType::RBRACE);
+}
@@ -0,0 +1,63 @@
+#ifndef CHECKER_H
+#define CHECKER_H
+
+#include "lexer.h"
+#include "symtab.h"
+#include "token.h"
+#include "tokenstream.h"
+#include <string>
+#include <vector>
+
+class Checker {
+private:
+    static const size_t DEFAULT_MAX_ERRORS = 100;
+    static const int MAX_EXPRESSION_DEPTH = 10000;
+    TokenStream tokens;
+    Token currentToken;
+    std::vector<std::string> errors;
+    std::vector<std::string> semanticErrors;
+    ScopedSymbolTable symbols;
+    SymbolType functionReturnType;
+    size_t maxErrors;
+    size_t maxSemanticErrors;
+    bool suppressCascades;
+    bool recovering;
+    bool aborted;
+    std::vector<int> exprHeights;
+    int exprNesting;
+    bool exprTooDeep;
+    void nextToken();
+    void error(const std::string& message);
+    void semanticError(const std::string& message, int line);
+    void match(TokenType expected);
+    void synchronizeToStatementEnd();
+    SymbolType checkType();
+    void checkBegin();
+    void checkFunctionName();
+    void checkDescriptions();
+    void checkDescr();
+    void checkVarList(SymbolType type);
+    void declare(SymbolType type);
+    void checkOperators();
+    void checkOp();
+    void beginExpr();
+    void exprOperand();
+    void exprOperator();
+    void expressionTooDeep();
+    void checkNumExpr(const SymbolInfo* target, int line);
+    bool checkSimpleNumExpr(const SymbolInfo* target, int line);
+    void checkStringExpr();
+    void checkSimpleStringExpr();
+    void checkEnd();
+public:
+    Checker(Lexer& l);
+    void setMaxErrors(size_t limit);
+    void setSuppressCascades(bool suppress);
+    bool check();
+    bool hasSyntaxErrors() const;
+    bool hasSemanticErrors() const;
+    const std::vector<std::string>& getSyntaxErrors() const;
+    const std::vector<std::string>& getSemanticErrors() const;
+};
+
+#endif
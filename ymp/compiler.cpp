@@ -0,0 +1,260 @@
+#include "compiler.h"
+#include "alloctrack.h"
+#include "bytecode.h"
+#include "cbackend.h"
+#include "checker.h"
+#include "dataflow.h"
+#include "ir.h"
+#include "lexer.h"
+#include "parser.h"
+#include "postfix.h"
+#include "semantic.h"
+#include "sourcecheck.h"
+#include "trace.h"
+#include "vm.h"
+
+CompileOptions::CompileOptions() : optimize(true), checkOnly(false), emitC(false), allErrors(false), warnings(false), maxErrors(DEFAULT_MAX_ERRORS), emitBytecode(false), profileRuns(0) {
+}
+
+CompileResult::CompileResult() : success(false), inputRejected(false) {
+}
+
+void CompileResult::clear() {
+    success = false;
+    inputRejected = false;
+    syntaxErrors.clear();
+    semanticErrors.clear();
+    codegenErrors.clear();
+    warnings.clear();
+    output.clear();
+    cSource.clear();
+    profileReport.clear();
+    bytecode.clear();
+}
+
+Compiler::Compiler() : outputSink(current.output), cSink(current.cSource), buffer(outputSink), asciiSource(false) {
+}
+
+const CompileResult& Compiler::compile(std::string_view source, const CompileOptions& options) {
+    current.clear();
+    buffer.setSink(&outputSink);
+    if (!looksLikeText(source.data(), source.size())) {
+        current.inputRejected = true;
+        buffer.append("INPUT ERROR: input does not look like program text\n");
+    }
+    else if (!checkEncoding(source)) {
+        current.inputRejected = true;
+    }
+    else if (options.checkOnly) {
+        checkOnly(source, options);
+    }
+    else {
+        compileFull(source, options);
+    }
+    buffer.flush();
+    return current;
+}
+
+// The strings stay owned by the compiler and are cleared, not freed, by the
+// next compile; a caller can swap them out for buffers of its own.
+CompileResult& Compiler::result() {
+    return current;
+}
+
+bool Compiler::checkEncoding(std::string_view source) {
+    TraceScope scope("checkEncoding", "phase");
+    EncodingCheck check = ::checkEncoding(source.data(), source.size());
+    asciiSource = check.ascii;
+    if (check.valid()) {
+        return true;
+    }
+    int line = 1;
+    size_t scanned = 0;
+    for (size_t offset : check.invalidOffsets) {
+        for (; scanned < offset; scanned++) {
+            if (source[scanned] == '\n') {
+                line++;
+            }
+        }
+        buffer.append("INPUT ERROR: invalid UTF-8 sequence at line ");
+        buffer.appendInt(line);
+        buffer.append(", byte offset ");
+        buffer.appendInt(static_cast<long long>(offset));
+        buffer.put('\n');
+    }
+    return false;
+}
+
+void Compiler::writeErrors(const char* header, const std::vector<std::string>& errors) {
+    buffer.append(header);
+    for (const auto& error : errors) {
+        buffer.append(error);
+        buffer.put('\n');
+    }
+}
+
+void Compiler::checkOnly(std::string_view source, const CompileOptions& options) {
+    Lexer lexer(source.data(), source.size());
+    lexer.setAsciiOnly(asciiSource);
+    Checker checker(lexer);
+    checker.setMaxErrors(options.maxErrors);
+    checker.setSuppressCascades(!options.allErrors);
+    {
+        TraceScope scope("Checker::check", "phase");
+        AllocPhaseScope allocPhase(AllocPhase::PARSER);
+        AllocCategoryScope allocCategory(AllocCategory::PARSE_TREE);
+        current.success = checker.check();
+    }
+    current.syntaxErrors = checker.getSyntaxErrors();
+    current.semanticErrors = checker.getSemanticErrors();
+    if (checker.hasSyntaxErrors()) {
+        writeErrors("SYNTAX ERRORS:\n", current.syntaxErrors);
+        return;
+    }
+    buffer.append("No syntax errors found.\n");
+    if (checker.hasSemanticErrors()) {
+        writeErrors("SEMANTIC ERRORS:\n", current.semanticErrors);
+    }
+    else {
+        buffer.append("No semantic errors found.\n");
+    }
+}
+
+void Compiler::compileFull(std::string_view source, const CompileOptions& options) {
+    Lexer lexer(source.data(), source.size());
+    lexer.setAsciiOnly(asciiSource);
+    Parser parser(lexer);
+    parser.setMaxErrors(options.maxErrors);
+    parser.setSuppressCascades(!options.allErrors);
+    std::shared_ptr<ParseTreeNode> syntaxTree;
+    {
+        TraceScope scope("Parser::parseFunction", "phase");
+        AllocPhaseScope allocPhase(AllocPhase::PARSER);
+        AllocCategoryScope allocCategory(AllocCategory::PARSE_TREE);
+        syntaxTree = parser.parseFunction();
+    }
+    if (parser.hasErrors()) {
+        current.syntaxErrors = parser.getErrors();
+        writeErrors("SYNTAX ERRORS:\n", current.syntaxErrors);
+        return;
+    }
+    buffer.append("No syntax errors found.\n");
+    semanticAnalyzer.clear();
+    semanticAnalyzer.setMaxErrors(options.maxErrors);
+    {
+        TraceScope scope("SemanticAnalyzer::analyze", "phase");
+        AllocPhaseScope allocPhase(AllocPhase::SEMANTIC);
+        semanticAnalyzer.analyze(syntaxTree);
+    }
+    if (semanticAnalyzer.hasErrors()) {
+        current.semanticErrors = semanticAnalyzer.getErrors();
+        writeErrors("SEMANTIC ERRORS:\n", current.semanticErrors);
+    }
+    else {
+        buffer.append("No semantic errors found.\n");
+    }
+    {
+        TraceScope scope("IrBuilder::build", "phase");
+        AllocPhaseScope allocPhase(AllocPhase::IR);
+        AllocCategoryScope allocCategory(AllocCategory::IR);
+        irBuilder.build(syntaxTree, program);
+    }
+    if (!semanticAnalyzer.hasErrors()) {
+        TraceScope scope("DataflowAnalyzer::run", "phase");
+        AllocPhaseScope allocPhase(AllocPhase::SEMANTIC);
+        dataflow.clear();
+        dataflow.run(program);
+        current.warnings = dataflow.getWarnings();
+    }
+    if (options.warnings && !current.warnings.empty()) {
+        writeErrors("WARNINGS:\n", current.warnings);
+    }
+    if (options.optimize && !semanticAnalyzer.hasErrors()) {
+        TraceScope scope("IrOptimizer::run", "phase");
+        AllocPhaseScope allocPhase(AllocPhase::IR);
+        AllocCategoryScope allocCategory(AllocCategory::IR);
+        IrOptimizer optimizer;
+        optimizer.run(program);
+    }
+    {
+        TraceScope scope("generatePostfix", "phase");
+        AllocPhaseScope allocPhase(AllocPhase::EMIT);
+        AllocCategoryScope allocCategory(AllocCategory::OUTPUT);
+        PostfixEmitter emitter(buffer);
+        emitter.emit(program);
+    }
+    current.success = !semanticAnalyzer.hasErrors();
+    if ((options.emitBytecode || options.profileRuns != 0) && current.success) {
+        emitBytecode(options);
+    }
+    if (options.emitC && current.success) {
+        TraceScope scope("CBackend::generate", "phase");
+        AllocPhaseScope allocPhase(AllocPhase::CODEGEN);
+        AllocCategoryScope allocCategory(AllocCategory::OUTPUT);
+        buffer.setSink(&cSink);
+        CBackend backend(buffer);
+        for (const IrVariable& variable : program.variables) {
+            if (variable.dead) {
+                backend.omitVariable(variable.name);
+            }
+        }
+        if (!backend.generate(syntaxTree)) {
+            current.codegenErrors = backend.getErrors();
+            current.cSource.clear();
+            current.success = false;
+            buffer.setSink(&outputSink);
+            writeErrors("CODEGEN ERRORS:\n", current.codegenErrors);
+        }
+    }
+}
+
+void Compiler::emitBytecode(const CompileOptions& options) {
+    BytecodeProgram bytecode;
+    {
+        TraceScope scope("BytecodeEmitter::emit", "phase");
+        BytecodeEmitter emitter;
+        bytecode = emitter.emit(program);
+        if (options.optimize) {
+            BytecodeOptimizer optimizer;
+            optimizer.run(bytecode);
+        }
+    }
+    if (options.emitBytecode) {
+        StringSink sink(current.bytecode);
+        OutputBuffer out(sink);
+        disassemble(bytecode, out);
+        out.flush();
+    }
+    if (options.profileRuns != 0) {
+        profile(bytecode, options.profileRuns);
+    }
+}
+
+void Compiler::profile(const BytecodeProgram& bytecode, unsigned runs) {
+    TraceScope scope("VirtualMachine::run", "phase");
+    ExecutionProfile executionProfile;
+    executionProfile.reset(bytecode);
+    VirtualMachine vm(bytecode);
+    vm.setProfile(&executionProfile);
+    for (unsigned i = 0; i < runs; i++) {
+        vm.run();
+    }
+    StringSink sink(current.profileReport);
+    OutputBuffer out(sink);
+    executionProfile.report(bytecode, out);
+    out.append("\nRESULT: ");
+    if (!vm.hasResult()) {
+        out.append("none");
+    }
+    else if (bytecode.returnType == IrType::CHAR_TYPE) {
+        out.put('"');
+        out.append(vm.getStringResult());
+        out.put('"');
+    }
+    else {
+        out.appendInt(vm.getIntResult());
+    }
+    out.put('\n');
+    disassemble(bytecode, out);
+    out.flush();
+}
@@ -0,0 +1,68 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include "dataflow.h"
+#include "ir.h"
+#include "output.h"
+#include "semantic.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct CompileOptions {
+    static const size_t DEFAULT_MAX_ERRORS = 100;
+    bool optimize;
+    bool checkOnly;
+    bool emitC;
+    bool allErrors;
+    bool warnings;
+    size_t maxErrors;
+    bool emitBytecode;
+    unsigned profileRuns;
+    CompileOptions();
+};
+
+struct CompileResult {
+    bool success;
+    bool inputRejected;
+    std::vector<std::string> syntaxErrors;
+    std::vector<std::string> semanticErrors;
+    std::vector<std::string> codegenErrors;
+    std::vector<std::string> warnings;
+    std::string output;
+    std::string cSource;
+    std::string profileReport;
+    std::string bytecode;
+    CompileResult();
+    void clear();
+};
+
+struct BytecodeProgram;
+
+class Compiler {
+private:
+    CompileResult current;
+    SemanticAnalyzer semanticAnalyzer;
+    IrBuilder irBuilder;
+    DataflowAnalyzer dataflow;
+    IrFunction program;
+    StringSink outputSink;
+    StringSink cSink;
+    OutputBuffer buffer;
+    bool asciiSource;
+    bool checkEncoding(std::string_view source);
+    void writeErrors(const char* header, const std::vector<std::string>& errors);
+    void checkOnly(std::string_view source, const CompileOptions& options);
+    void compileFull(std::string_view source, const CompileOptions& options);
+    void emitBytecode(const CompileOptions& options);
+    void profile(const BytecodeProgram& bytecode, unsigned runs);
+public:
+    Compiler();
+    Compiler(const Compiler&) = delete;
+    Compiler& operator=(const Compiler&) = delete;
+    const CompileResult& compile(std::string_view source, const CompileOptions& options = CompileOptions());
+    CompileResult& result();
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include "complexity.h"
+#include "asyncwriter.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static const size_t EXCERPT_LENGTH = 48;
+
+ComplexityBudget::ComplexityBudget()
+    : baseNs(20000000), nsPerByte(5000), baseAllocations(4096), allocationsPerByte(8), basePeakBytes(1 << 20), peakBytesPerByte(256) {
+}
+
+long long ComplexityBudget::maxNs(size_t size) const {
+    return baseNs + nsPerByte * static_cast<long long>(size);
+}
+
+long long ComplexityBudget::maxAllocations(size_t size) const {
+    return baseAllocations + allocationsPerByte * static_cast<long long>(size);
+}
+
+long long ComplexityBudget::maxPeakBytes(size_t size) const {
+    return basePeakBytes + peakBytesPerByte * static_cast<long long>(size);
+}
+
+ComplexityMeasurement::ComplexityMeasurement() : size(0), ns(0), allocations(0), peakBytes(0), phaseAllocations() {
+}
+
+ComplexityProbe::ComplexityProbe(const CompileOptions& o, size_t k) : options(o), tracer(TraceLevel::PHASES), keep(k) {
+}
+
+const ComplexityMeasurement& ComplexityProbe::measure(std::string_view source) {
+    Tracer* previousTracer = Tracer::active();
+    bool previousTracking = AllocTracker::enabled();
+    Tracer::setActive(&tracer);
+    AllocStats before = AllocTracker::totalStats();
+    long long phaseBefore[static_cast<int>(AllocPhase::COUNT)];
+    for (int i = 0; i < static_cast<int>(AllocPhase::COUNT); i++) {
+        phaseBefore[i] = AllocTracker::phaseStats(static_cast<AllocPhase>(i)).count;
+    }
+    AllocTracker::resetPeaks();
+    AllocTracker::setEnabled(true);
+    auto start = std::chrono::steady_clock::now();
+    compiler.compile(source, options);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    AllocTracker::setEnabled(previousTracking);
+    Tracer::setActive(previousTracer);
+
+    measurement.size = source.size();
+    measurement.ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    AllocStats after = AllocTracker::totalStats();
+    measurement.allocations = after.count - before.count;
+    measurement.peakBytes = after.peakLiveBytes - before.liveBytes;
+    for (int i = 0; i < static_cast<int>(AllocPhase::COUNT); i++) {
+        measurement.phaseAllocations[i] = AllocTracker::phaseStats(static_cast<AllocPhase>(i)).count - phaseBefore[i];
+    }
+    measurement.phases.clear();
+    tracer.takeEvents(events);
+    for (const TraceEvent& event : events) {
+        if (std::strcmp(event.category, "phase") != 0) {
+            continue;
+        }
+        bool found = false;
+        for (PhaseTime& phase : measurement.phases) {
+            if (std::strcmp(phase.name, event.name) == 0) {
+                phase.ns += event.durationNs;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            measurement.phases.push_back({ event.name, event.durationNs });
+        }
+    }
+    return measurement;
+}
+
+bool ComplexityProbe::record(std::string_view source) {
+    measure(source);
+    bool slower = remember("total", "ns", source, measurement.ns);
+    slower = remember("total", "allocations", source, measurement.allocations) || slower;
+    slower = remember("total", "peak bytes", source, measurement.peakBytes) || slower;
+    for (const PhaseTime& phase : measurement.phases) {
+        slower = remember(phase.name, "ns", source, phase.ns) || slower;
+    }
+    if (AllocTracker::available()) {
+        for (int i = 0; i < static_cast<int>(AllocPhase::COUNT); i++) {
+            slower = remember(AllocTracker::phaseName(static_cast<AllocPhase>(i)), "allocations", source, measurement.phaseAllocations[i]) || slower;
+        }
+    }
+    return slower;
+}
+
+bool ComplexityProbe::remember(const std::string& phase, const char* unit, std::string_view source, long long cost) {
+    if (cost <= 0) {
+        return false;
+    }
+    SlowestInputs* entry = nullptr;
+    for (SlowestInputs& candidate : slowest) {
+        if (candidate.phase == phase && std::strcmp(candidate.unit, unit) == 0) {
+            entry = &candidate;
+            break;
+        }
+    }
+    if (entry == nullptr) {
+        slowest.push_back({ phase, unit, std::vector<SlowInput>() });
+        entry = &slowest.back();
+    }
+    std::vector<SlowInput>& inputs = entry->inputs;
+    size_t rank = inputs.size();
+    while (rank > 0 && inputs[rank - 1].cost < cost) {
+        rank--;
+    }
+    if (rank >= keep) {
+        return false;
+    }
+    inputs.insert(inputs.begin() + rank, { std::string(source), cost });
+    if (inputs.size() > keep) {
+        inputs.pop_back();
+    }
+    return true;
+}
+
+const ComplexityMeasurement& ComplexityProbe::getMeasurement() const {
+    return measurement;
+}
+
+const std::vector<SlowestInputs>& ComplexityProbe::getSlowest() const {
+    return slowest;
+}
+
+void ComplexityProbe::writeSlowest(const std::string& directory) const {
+    AsyncWriter writer;
+    for (const SlowestInputs& entry : slowest) {
+        std::string prefix = directory + "/slowest-" + entry.phase + "-" + entry.unit + "-";
+        for (char& c : prefix) {
+            if (c == ':') {
+                c = '_';
+            }
+        }
+        for (size_t i = 0; i < entry.inputs.size(); i++) {
+            writer.writeFile(prefix + std::to_string(i + 1) + ".txt", std::string(entry.inputs[i].source));
+        }
+    }
+    writer.drain();
+}
+
+void ComplexityProbe::report(OutputBuffer& out) const {
+    out.append("\n=== SLOWEST INPUTS ===\n");
+    for (const SlowestInputs& entry : slowest) {
+        out.append(entry.phase);
+        out.append(" (");
+        out.append(entry.unit);
+        out.append("):\n");
+        for (size_t i = 0; i < entry.inputs.size(); i++) {
+            const SlowInput& input = entry.inputs[i];
+            char line[96];
+            std::snprintf(line, sizeof(line), "%4zu. %14lld %10zu bytes  ", i + 1, input.cost, input.source.size());
+            out.append(line);
+            for (size_t j = 0; j < input.source.size() && j < EXCERPT_LENGTH; j++) {
+                unsigned char c = static_cast<unsigned char>(input.source[j]);
+                out.put(c < 0x20 || c == 0x7f ? ' ' : input.source[j]);
+            }
+            out.put('\n');
+        }
+    }
+}
+
+bool checkBudget(const ComplexityMeasurement& measurement, const ComplexityBudget& budget, std::string& violation) {
+    char message[160];
+    if (measurement.ns > budget.maxNs(measurement.size)) {
+        std::snprintf(message, sizeof(message), "time %lld ns exceeds budget %lld ns for %zu bytes",
+            measurement.ns, budget.maxNs(measurement.size), measurement.size);
+        violation = message;
+        return false;
+    }
+    if (AllocTracker::available() && measurement.allocations > budget.maxAllocations(measurement.size)) {
+        std::snprintf(message, sizeof(message), "%lld allocations exceed budget %lld for %zu bytes",
+            measurement.allocations, budget.maxAllocations(measurement.size), measurement.size);
+        violation = message;
+        return false;
+    }
+    if (AllocTracker::available() && measurement.peakBytes > budget.maxPeakBytes(measurement.size)) {
+        std::snprintf(message, sizeof(message), "peak of %lld live bytes exceeds budget %lld for %zu bytes",
+            measurement.peakBytes, budget.maxPeakBytes(measurement.size), measurement.size);
+        violation = message;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef COMPLEXITY_H
+#define COMPLEXITY_H
+
+#include "alloctrack.h"
+#include "compiler.h"
+#include "output.h"
+#include "trace.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct ComplexityBudget {
+    long long baseNs;
+    long long nsPerByte;
+    long long baseAllocations;
+    long long allocationsPerByte;
+    long long basePeakBytes;
+    long long peakBytesPerByte;
+    ComplexityBudget();
+    long long maxNs(size_t size) const;
+    long long maxAllocations(size_t size) const;
+    long long maxPeakBytes(size_t size) const;
+};
+
+struct PhaseTime {
+    const char* name;
+    long long ns;
+};
+
+struct ComplexityMeasurement {
+    size_t size;
+    long long ns;
+    long long allocations;
+    long long peakBytes;
+    long long phaseAllocations[static_cast<int>(AllocPhase::COUNT)];
+    std::vector<PhaseTime> phases;
+    ComplexityMeasurement();
+};
+
+struct SlowInput {
+    std::string source;
+    long long cost;
+};
+
+struct SlowestInputs {
+    std::string phase;
+    const char* unit;
+    std::vector<SlowInput> inputs;
+};
+
+class ComplexityProbe {
+private:
+    static const size_t DEFAULT_KEEP = 4;
+    Compiler compiler;
+    CompileOptions options;
+    Tracer tracer;
+    std::vector<TraceEvent> events;
+    ComplexityMeasurement measurement;
+    std::vector<SlowestInputs> slowest;
+    size_t keep;
+    bool remember(const std::string& phase, const char* unit, std::string_view source, long long cost);
+public:
+    ComplexityProbe(const CompileOptions& o = CompileOptions(), size_t k = DEFAULT_KEEP);
+    ComplexityProbe(const ComplexityProbe&) = delete;
+    ComplexityProbe& operator=(const ComplexityProbe&) = delete;
+    const ComplexityMeasurement& measure(std::string_view source);
+    bool record(std::string_view source);
+    const ComplexityMeasurement& getMeasurement() const;
+    const std::vector<SlowestInputs>& getSlowest() const;
+    void writeSlowest(const std::string& directory) const;
+    void report(OutputBuffer& out) const;
+};
+
+bool checkBudget(const ComplexityMeasurement& measurement, const ComplexityBudget& budget, std::string& violation);
+
+#endif
@@ -0,0 +1,148 @@
+#include "concurrenthashtable.h"
+#include <thread>
+
+ConcurrentHashTable::Entry::Entry(const std::string& v, TokenType t, int idx, Entry* n)
+    : value(v), type(t), index(idx), next(n) {
+}
+
+ConcurrentHashTable::Table::Table(size_t s) : size(s), heads(new std::atomic<Entry*>[s]) {
+    for (size_t i = 0; i < size; i++) {
+        heads[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+ConcurrentHashTable::Table::~Table() {
+    delete[] heads;
+}
+
+ConcurrentHashTable::Shard::Shard() : table(new Table(INITIAL_BUCKETS)), generation(0), count(0) {
+}
+
+ConcurrentHashTable::ConcurrentHashTable() : nextIndex(0) {
+}
+
+ConcurrentHashTable::~ConcurrentHashTable() {
+    for (Shard& shard : shards) {
+        Table* live = shard.table.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < live->size; i++) {
+            Entry* entry = live->heads[i].load(std::memory_order_relaxed);
+            while (entry != nullptr) {
+                Entry* next = entry->next.load(std::memory_order_relaxed);
+                delete entry;
+                entry = next;
+            }
+        }
+        delete live;
+        for (Table* table : shard.retired) {
+            delete table;
+        }
+    }
+}
+
+unsigned ConcurrentHashTable::hash(const std::string& value) {
+    unsigned h = 2166136261u;
+    for (char c : value) {
+        h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return h;
+}
+
+int ConcurrentHashTable::findIn(const Table* table, size_t bucket, const Token& token) {
+    for (const Entry* entry = table->heads[bucket].load(std::memory_order_acquire); entry != nullptr; entry = entry->next.load(std::memory_order_acquire)) {
+        if (entry->type == token.type && entry->value == token.value) {
+            return entry->index;
+        }
+    }
+    return -1;
+}
+
+// A hit is always genuine, but a miss is only trusted if no grow ran during
+// the walk: grow re-links entries, so a reader on an old chain can be carried
+// into another bucket. The generation is odd while a grow is in progress.
+int ConcurrentHashTable::find(const Token& token) const {
+    unsigned h = hash(token.value);
+    const Shard& shard = shards[h % SHARD_COUNT];
+    for (;;) {
+        unsigned generation = shard.generation.load(std::memory_order_acquire);
+        const Table* table = shard.table.load(std::memory_order_acquire);
+        int index = findIn(table, (h / SHARD_COUNT) & (table->size - 1), token);
+        if (index >= 0) {
+            return index;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((generation & 1) == 0 && shard.generation.load(std::memory_order_relaxed) == generation) {
+            return -1;
+        }
+        std::this_thread::yield();
+    }
+}
+
+// Moves the entries into a bucket array twice the size by re-linking the
+// existing nodes. Only the old array is retired; it is kept until the table is
+// destroyed because a lock-free reader may still be walking it, and all the
+// retired arrays of a shard together are smaller than its live one.
+void ConcurrentHashTable::grow(Shard& shard) {
+    Table* old = shard.table.load(std::memory_order_relaxed);
+    Table* table = new Table(old->size * 2);
+    shard.generation.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < old->size; i++) {
+        Entry* entry = old->heads[i].load(std::memory_order_relaxed);
+        while (entry != nullptr) {
+            Entry* next = entry->next.load(std::memory_order_relaxed);
+            size_t bucket = (hash(entry->value) / SHARD_COUNT) & (table->size - 1);
+            entry->next.store(table->heads[bucket].load(std::memory_order_relaxed), std::memory_order_release);
+            table->heads[bucket].store(entry, std::memory_order_relaxed);
+            entry = next;
+        }
+    }
+    shard.retired.push_back(old);
+    shard.table.store(table, std::memory_order_release);
+    shard.generation.fetch_add(1, std::memory_order_release);
+}
+
+int ConcurrentHashTable::insert(const Token& token) {
+    unsigned h = hash(token.value);
+    Shard& shard = shards[h % SHARD_COUNT];
+    Table* table = shard.table.load(std::memory_order_acquire);
+    int index = findIn(table, (h / SHARD_COUNT) & (table->size - 1), token);
+    if (index >= 0) {
+        return index;
+    }
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    table = shard.table.load(std::memory_order_relaxed);
+    size_t bucket = (h / SHARD_COUNT) & (table->size - 1);
+    index = findIn(table, bucket, token);
+    if (index >= 0) {
+        return index;
+    }
+    if (shard.count >= table->size) {
+        grow(shard);
+        table = shard.table.load(std::memory_order_relaxed);
+        bucket = (h / SHARD_COUNT) & (table->size - 1);
+    }
+    index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+    Entry* entry = new Entry(token.value, token.type, index, table->heads[bucket].load(std::memory_order_relaxed));
+    table->heads[bucket].store(entry, std::memory_order_release);
+    shard.count++;
+    return index;
+}
+
+int ConcurrentHashTable::size() const {
+    return nextIndex.load(std::memory_order_relaxed);
+}
+
+void ConcurrentHashTable::snapshot(std::vector<Token>& out) {
+    out.assign(static_cast<size_t>(size()), Token());
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const Table* table = shard.table.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < table->size; i++) {
+            for (const Entry* entry = table->heads[i].load(std::memory_order_relaxed); entry != nullptr; entry = entry->next.load(std::memory_order_relaxed)) {
+                if (static_cast<size_t>(entry->index) < out.size()) {
+                    out[entry->index] = Token(entry->type, entry->value);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef CONCURRENTHASHTABLE_H
+#define CONCURRENTHASHTABLE_H
+
+#include "token.h"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ConcurrentHashTable {
+private:
+    static const size_t SHARD_COUNT = 64;
+    static const size_t INITIAL_BUCKETS = 16;
+    struct Entry {
+        std::string value;
+        TokenType type;
+        int index;
+        std::atomic<Entry*> next;
+        Entry(const std::string& v, TokenType t, int idx, Entry* n);
+    };
+    struct Table {
+        size_t size;
+        std::atomic<Entry*>* heads;
+        Table(size_t s);
+        Table(const Table&) = delete;
+        Table& operator=(const Table&) = delete;
+        ~Table();
+    };
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::atomic<Table*> table;
+        std::atomic<unsigned> generation;
+        std::vector<Table*> retired;
+        size_t count;
+        Shard();
+    };
+    Shard shards[SHARD_COUNT];
+    std::atomic<int> nextIndex;
+    static unsigned hash(const std::string& value);
+    static int findIn(const Table* table, size_t bucket, const Token& token);
+    void grow(Shard& shard);
+public:
+    ConcurrentHashTable();
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+    ~ConcurrentHashTable();
+    int find(const Token& token) const;
+    int insert(const Token& token);
+    int size() const;
+    void snapshot(std::vector<Token>& out);
+};
+
+#endif
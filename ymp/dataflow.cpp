@@ -0,0 +1,51 @@
+#include "dataflow.h"
+
+void DataflowAnalyzer::addWarning(const std::string& message, int line) {
+    warnings.push_back("Warning at line " + std::to_string(line) + ": " + message);
+}
+
+void DataflowAnalyzer::run(IrFunction& function) {
+    size_t count = function.variables.size();
+    std::vector<bool> assigned(count, false);
+    std::vector<bool> read(count, false);
+    std::vector<bool> reported(count, false);
+    auto markRead = [&](const IrOperand& operand, int line) {
+        if (operand.kind != IrOperandKind::VERSION) return;
+        int variable = function.variableOf(operand);
+        read[variable] = true;
+        if (function.versions[operand.index].number == 0 && function.variables[variable].declared && !reported[variable]) {
+            reported[variable] = true;
+            addWarning("variable '" + function.variables[variable].name + "' is read before it is assigned", line);
+        }
+    };
+    for (const IrInstr& instr : function.code) {
+        markRead(instr.a, instr.line);
+        markRead(instr.b, instr.line);
+        if (instr.op == IrOp::DEF) {
+            assigned[function.versions[instr.result].variable] = true;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        IrVariable& variable = function.variables[i];
+        if (!variable.declared || read[i]) continue;
+        if (assigned[i]) {
+            addWarning("variable '" + variable.name + "' is assigned but never read", variable.line);
+        }
+        else {
+            addWarning("variable '" + variable.name + "' is declared but never used", variable.line);
+            variable.dead = true;
+        }
+    }
+}
+
+void DataflowAnalyzer::clear() {
+    warnings.clear();
+}
+
+bool DataflowAnalyzer::hasWarnings() const {
+    return !warnings.empty();
+}
+
+const std::vector<std::string>& DataflowAnalyzer::getWarnings() const {
+    return warnings;
+}
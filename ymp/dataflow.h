@@ -0,0 +1,19 @@
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include "ir.h"
+#include <string>
+#include <vector>
+
+class DataflowAnalyzer {
+private:
+    std::vector<std::string> warnings;
+    void addWarning(const std::string& message, int line);
+public:
+    void run(IrFunction& function);
+    void clear();
+    bool hasWarnings() const;
+    const std::vector<std::string>& getWarnings() const;
+};
+
+#endif
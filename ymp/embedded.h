@@ -0,0 +1,829 @@
+#ifndef EMBEDDED_H
+#define EMBEDDED_H
+
+#include "bytecode.h"
+#include "token.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+enum class EmbeddedError {
+    NONE,
+    EXPECTED_TOKEN,
+    EXPECTED_TYPE,
+    UNKNOWN_TYPE,
+    EXPECTED_FUNCTION_NAME,
+    EXPECTED_VARIABLE,
+    EXPECTED_VARIABLE_AFTER_COMMA,
+    EXPECTED_ASSIGNMENT_TARGET,
+    EXPECTED_ASSIGN,
+    EXPECTED_OPERAND,
+    EXPECTED_RPAREN,
+    EXPECTED_STRING,
+    INVALID_TOKEN,
+    INTEGER_OUT_OF_RANGE,
+    EXPECTED_RETURN,
+    EXPECTED_RETURN_IDENTIFIER,
+    ALREADY_DECLARED,
+    UNDECLARED_VARIABLE,
+    FUNCTION_OPERAND,
+    TYPE_MISMATCH,
+    UNDECLARED_RETURN,
+    RETURN_FUNCTION,
+    RETURN_TYPE_MISMATCH,
+    TOO_LARGE
+};
+
+constexpr const char* embeddedErrorMessage(EmbeddedError error) {
+    switch (error) {
+    case EmbeddedError::NONE: return "no error";
+    case EmbeddedError::EXPECTED_TOKEN: return "Unexpected token";
+    case EmbeddedError::EXPECTED_TYPE: return "Expected type (int or char)";
+    case EmbeddedError::UNKNOWN_TYPE: return "Unknown type";
+    case EmbeddedError::EXPECTED_FUNCTION_NAME: return "Expected function name identifier";
+    case EmbeddedError::EXPECTED_VARIABLE: return "Expected identifier in variable list";
+    case EmbeddedError::EXPECTED_VARIABLE_AFTER_COMMA: return "Expected identifier after comma";
+    case EmbeddedError::EXPECTED_ASSIGNMENT_TARGET: return "Expected identifier at start of operator";
+    case EmbeddedError::EXPECTED_ASSIGN: return "Expected '=' in operator";
+    case EmbeddedError::EXPECTED_OPERAND: return "Expected identifier, constant or '(' in numeric expression";
+    case EmbeddedError::EXPECTED_RPAREN: return "Expected ')' after expression";
+    case EmbeddedError::EXPECTED_STRING: return "Expected string constant";
+    case EmbeddedError::INVALID_TOKEN: return "Invalid token in expression";
+    case EmbeddedError::INTEGER_OUT_OF_RANGE: return "Integer constant is out of range";
+    case EmbeddedError::EXPECTED_RETURN: return "Expected RETURN";
+    case EmbeddedError::EXPECTED_RETURN_IDENTIFIER: return "Expected identifier after return";
+    case EmbeddedError::ALREADY_DECLARED: return "Name already declared";
+    case EmbeddedError::UNDECLARED_VARIABLE: return "Undeclared variable";
+    case EmbeddedError::FUNCTION_OPERAND: return "Cannot use function as a value";
+    case EmbeddedError::TYPE_MISMATCH: return "Type mismatch in assignment";
+    case EmbeddedError::UNDECLARED_RETURN: return "Undeclared variable in return statement";
+    case EmbeddedError::RETURN_FUNCTION: return "Cannot return function";
+    case EmbeddedError::RETURN_TYPE_MISMATCH: return "Function return type does not match variable";
+    case EmbeddedError::TOO_LARGE: return "Program exceeds embedded capacity";
+    }
+    return "unknown error";
+}
+
+struct EmbeddedDiagnostic {
+    EmbeddedError error = EmbeddedError::NONE;
+    bool semantic = false;
+    int line = 0;
+    int position = 0;
+    TokenType expected = TokenType::END_OF_FILE;
+};
+
+struct EmbeddedSpan {
+    size_t offset = 0;
+    size_t length = 0;
+};
+
+struct EmbeddedToken {
+    TokenType type = TokenType::END_OF_FILE;
+    EmbeddedSpan text;
+    int line = 1;
+    int position = 0;
+    int intValue = 0;
+    bool outOfRange = false;
+};
+
+struct EmbeddedInstruction {
+    OpCode op = OpCode::PUSH_INT;
+    int operand = 0;
+    int line = 0;
+};
+
+struct EmbeddedVariable {
+    EmbeddedSpan name;
+    IrType type = IrType::INT_TYPE;
+    int line = 0;
+    bool declared = false;
+    bool read = false;
+    bool assigned = false;
+};
+
+struct EmbeddedDeclGroup {
+    IrType type = IrType::INT_TYPE;
+    int first = 0;
+    int count = 0;
+};
+
+constexpr bool isEmbeddedSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+constexpr bool isEmbeddedAlpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+constexpr bool isEmbeddedDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool isEmbeddedDelimiter(char c) {
+    switch (c) {
+    case '+': case '-': case '=': case '(': case ')': case '{': case '}': case ',': case ';': case '"': case '/': case '\0':
+        return true;
+    default:
+        return isEmbeddedSpace(c);
+    }
+}
+
+template <size_t N>
+class EmbeddedCompiler;
+
+template <size_t N>
+class EmbeddedProgram {
+public:
+    static constexpr size_t MAX_ITEMS = N + 1;
+    static constexpr size_t MAX_TEXT = 3 * N + 64;
+private:
+    friend class EmbeddedCompiler<N>;
+    char source[N + 1] = {};
+    EmbeddedDiagnostic diag;
+    EmbeddedSpan functionName;
+    IrType functionType = IrType::INT_TYPE;
+    EmbeddedVariable variables[MAX_ITEMS] = {};
+    int variableCount = 0;
+    EmbeddedDeclGroup decls[MAX_ITEMS] = {};
+    int declCount = 0;
+    EmbeddedSpan strings[MAX_ITEMS] = {};
+    int stringCount = 0;
+    EmbeddedInstruction code[MAX_ITEMS] = {};
+    int codeSize = 0;
+    int statementEnds[MAX_ITEMS] = {};
+    int statementCount = 0;
+    char text[MAX_TEXT] = {};
+    size_t textSize = 0;
+public:
+    constexpr bool ok() const {
+        return diag.error == EmbeddedError::NONE;
+    }
+    constexpr const EmbeddedDiagnostic& diagnostic() const {
+        return diag;
+    }
+    constexpr std::string_view name() const {
+        return spanText(functionName);
+    }
+    constexpr std::string_view postfix() const {
+        return std::string_view(text, textSize);
+    }
+    constexpr int size() const {
+        return codeSize;
+    }
+    constexpr const EmbeddedInstruction& instruction(int pc) const {
+        return code[pc];
+    }
+    constexpr std::string_view spanText(const EmbeddedSpan& span) const {
+        return std::string_view(source + span.offset, span.length);
+    }
+    BytecodeProgram toBytecode() const {
+        BytecodeProgram program;
+        program.name = std::string(name());
+        program.returnType = functionType;
+        for (int i = 0; i < variableCount; i++) {
+            program.variables.emplace_back(std::string(spanText(variables[i].name)), variables[i].type);
+        }
+        for (int i = 0; i < stringCount; i++) {
+            program.strings.emplace_back(spanText(strings[i]));
+        }
+        size_t first = 0;
+        for (int s = 0; s < statementCount; s++) {
+            for (int pc = static_cast<int>(first); pc < statementEnds[s]; pc++) {
+                program.code.emplace_back(code[pc].op, code[pc].operand, code[pc].line);
+            }
+            program.statements.emplace_back(first, static_cast<size_t>(statementEnds[s]), code[statementEnds[s] - 1].line);
+            first = static_cast<size_t>(statementEnds[s]);
+        }
+        return program;
+    }
+};
+
+template <size_t N>
+class EmbeddedCompiler {
+private:
+    static constexpr int FUNCTION_SYMBOL = -2;
+    static constexpr int NO_SYMBOL = -1;
+    EmbeddedProgram<N>& program;
+    size_t length;
+    size_t cursor;
+    int currentLine;
+    size_t lineStart;
+    EmbeddedToken current;
+    EmbeddedDiagnostic syntaxError;
+    EmbeddedDiagnostic semanticError;
+    int statementLine;
+    int targetVariable;
+    bool checkTarget;
+    bool failed;
+
+    constexpr char at(size_t offset) const {
+        return offset < length ? program.source[offset] : '\0';
+    }
+
+    constexpr bool spanEquals(const EmbeddedSpan& span, const char* word) const {
+        size_t i = 0;
+        for (; word[i] != '\0'; i++) {
+            if (i >= span.length || program.source[span.offset + i] != word[i]) {
+                return false;
+            }
+        }
+        return i == span.length;
+    }
+
+    constexpr bool sameName(const EmbeddedSpan& x, const EmbeddedSpan& y) const {
+        if (x.length != y.length) {
+            return false;
+        }
+        for (size_t i = 0; i < x.length; i++) {
+            if (program.source[x.offset + i] != program.source[y.offset + i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr void scanToken() {
+        while (cursor < length && isEmbeddedSpace(at(cursor))) {
+            if (at(cursor) == '\n') {
+                currentLine++;
+                lineStart = cursor + 1;
+            }
+            cursor++;
+        }
+        size_t start = cursor;
+        current = EmbeddedToken();
+        current.line = currentLine;
+        current.position = static_cast<int>(start - lineStart) + 1;
+        current.text.offset = start;
+        char c = at(cursor);
+        if (c == '\0') {
+            current.type = TokenType::END_OF_FILE;
+            current.position = static_cast<int>(start - lineStart);
+            return;
+        }
+        if (isEmbeddedAlpha(c)) {
+            bool alphabetic = true;
+            while (!isEmbeddedDelimiter(at(cursor))) {
+                alphabetic = alphabetic && isEmbeddedAlpha(at(cursor));
+                cursor++;
+            }
+            current.text.length = cursor - start;
+            if (spanEquals(current.text, "return")) {
+                current.type = TokenType::RETURN;
+            }
+            else if (spanEquals(current.text, "int")) {
+                current.type = TokenType::INT;
+            }
+            else if (spanEquals(current.text, "char")) {
+                current.type = TokenType::CHAR;
+            }
+            else {
+                current.type = alphabetic ? TokenType::ID : TokenType::ERROR;
+            }
+            return;
+        }
+        if (isEmbeddedDigit(c)) {
+            cursor++;
+            if (c == '0' && isEmbeddedDigit(at(cursor))) {
+                while (isEmbeddedDigit(at(cursor))) {
+                    cursor++;
+                }
+                current.type = TokenType::ERROR;
+            }
+            else {
+                long long value = c - '0';
+                while (isEmbeddedDigit(at(cursor))) {
+                    if (value <= 2147483647LL) {
+                        value = value * 10 + (at(cursor) - '0');
+                    }
+                    cursor++;
+                }
+                if (isEmbeddedDelimiter(at(cursor))) {
+                    current.type = TokenType::INT_NUM;
+                    current.outOfRange = value > 2147483647LL;
+                    current.intValue = current.outOfRange ? 0 : static_cast<int>(value);
+                }
+                else {
+                    while (!isEmbeddedDelimiter(at(cursor))) {
+                        cursor++;
+                    }
+                    current.type = TokenType::ERROR;
+                }
+            }
+            current.text.length = cursor - start;
+            return;
+        }
+        if (c == '"') {
+            cursor++;
+            while (at(cursor) != '"' && at(cursor) != '\0' && at(cursor) != '\n') {
+                cursor++;
+            }
+            if (at(cursor) == '"') {
+                cursor++;
+                current.type = TokenType::CHAR_CONST;
+            }
+            else {
+                current.type = TokenType::ERROR;
+            }
+            current.text.length = cursor - start;
+            return;
+        }
+        cursor++;
+        switch (c) {
+        case '+': current.type = TokenType::PLUS; break;
+        case '-': current.type = TokenType::MINUS; break;
+        case '=': current.type = TokenType::ASSIGN; break;
+        case '(': current.type = TokenType::LPAREN; break;
+        case ')': current.type = TokenType::RPAREN; break;
+        case '{': current.type = TokenType::LBRACE; break;
+        case '}': current.type = TokenType::RBRACE; break;
+        case ',': current.type = TokenType::COMMA; break;
+        case ';': current.type = TokenType::SEMICOLON; break;
+        default:
+            while (!isEmbeddedDelimiter(at(cursor))) {
+                cursor++;
+            }
+            current.type = TokenType::ERROR;
+            break;
+        }
+        current.text.length = cursor - start;
+    }
+
+    constexpr void error(EmbeddedError kind, TokenType expected = TokenType::END_OF_FILE) {
+        if (failed) {
+            return;
+        }
+        failed = true;
+        syntaxError.error = kind;
+        syntaxError.line = current.line;
+        syntaxError.position = current.position;
+        syntaxError.expected = expected;
+    }
+
+    constexpr void semantic(EmbeddedError kind, int line) {
+        if (semanticError.error != EmbeddedError::NONE) {
+            return;
+        }
+        semanticError.error = kind;
+        semanticError.semantic = true;
+        semanticError.line = line;
+    }
+
+    constexpr bool match(TokenType expected) {
+        if (failed) {
+            return false;
+        }
+        if (current.type != expected) {
+            error(EmbeddedError::EXPECTED_TOKEN, expected);
+            return false;
+        }
+        scanToken();
+        return true;
+    }
+
+    constexpr int findSymbol(const EmbeddedSpan& name) const {
+        if (program.functionName.length != 0 && sameName(program.functionName, name)) {
+            return FUNCTION_SYMBOL;
+        }
+        for (int i = 0; i < program.variableCount; i++) {
+            if (program.variables[i].declared && sameName(program.variables[i].name, name)) {
+                return i;
+            }
+        }
+        return NO_SYMBOL;
+    }
+
+    constexpr int lookupVariable(const EmbeddedSpan& name, IrType implicitType) {
+        for (int i = 0; i < program.variableCount; i++) {
+            if (sameName(program.variables[i].name, name)) {
+                return i;
+            }
+        }
+        EmbeddedVariable& variable = program.variables[program.variableCount];
+        variable.name = name;
+        variable.type = implicitType;
+        return program.variableCount++;
+    }
+
+    constexpr void emit(OpCode op, int operand, int line) {
+        program.code[program.codeSize++] = EmbeddedInstruction{ op, operand, line };
+    }
+
+    constexpr void endStatement() {
+        program.statementEnds[program.statementCount++] = program.codeSize;
+    }
+
+    constexpr bool parseType(IrType& type) {
+        if (current.type == TokenType::INT || current.type == TokenType::CHAR) {
+            type = current.type == TokenType::CHAR ? IrType::CHAR_TYPE : IrType::INT_TYPE;
+            scanToken();
+            return true;
+        }
+        error(current.type == TokenType::ID ? EmbeddedError::UNKNOWN_TYPE : EmbeddedError::EXPECTED_TYPE);
+        return false;
+    }
+
+    constexpr void parseBegin() {
+        if (!parseType(program.functionType)) {
+            return;
+        }
+        if (current.type != TokenType::ID) {
+            error(EmbeddedError::EXPECTED_FUNCTION_NAME);
+            return;
+        }
+        program.functionName = current.text;
+        scanToken();
+        match(TokenType::LPAREN);
+        match(TokenType::RPAREN);
+        match(TokenType::LBRACE);
+    }
+
+    constexpr void declare(IrType type) {
+        int symbol = findSymbol(current.text);
+        if (symbol != NO_SYMBOL) {
+            semantic(EmbeddedError::ALREADY_DECLARED, current.line);
+        }
+        else {
+            EmbeddedVariable& variable = program.variables[program.variableCount++];
+            variable.name = current.text;
+            variable.type = type;
+            variable.line = current.line;
+            variable.declared = true;
+        }
+        scanToken();
+    }
+
+    constexpr void parseDescr() {
+        IrType type = IrType::INT_TYPE;
+        parseType(type);
+        if (failed) {
+            return;
+        }
+        int first = program.variableCount;
+        if (current.type != TokenType::ID) {
+            error(EmbeddedError::EXPECTED_VARIABLE);
+            return;
+        }
+        declare(type);
+        while (!failed && current.type == TokenType::COMMA) {
+            scanToken();
+            if (current.type != TokenType::ID) {
+                error(EmbeddedError::EXPECTED_VARIABLE_AFTER_COMMA);
+                return;
+            }
+            declare(type);
+        }
+        if (program.variableCount > first) {
+            program.decls[program.declCount++] = EmbeddedDeclGroup{ type, first, program.variableCount - first };
+        }
+        match(TokenType::SEMICOLON);
+    }
+
+    constexpr IrType targetType() const {
+        return program.variables[targetVariable].type;
+    }
+
+    constexpr void loadOperand() {
+        int symbol = findSymbol(current.text);
+        if (checkTarget && symbol == NO_SYMBOL) {
+            semantic(EmbeddedError::UNDECLARED_VARIABLE, statementLine);
+        }
+        else if (checkTarget && symbol == FUNCTION_SYMBOL) {
+            semantic(EmbeddedError::FUNCTION_OPERAND, statementLine);
+        }
+        else if (checkTarget && program.variables[symbol].type != targetType()) {
+            semantic(EmbeddedError::TYPE_MISMATCH, statementLine);
+        }
+        int variable = lookupVariable(current.text, targetType());
+        program.variables[variable].read = true;
+        emit(program.variables[variable].type == IrType::CHAR_TYPE ? OpCode::LOAD_STR : OpCode::LOAD_INT, variable, statementLine);
+    }
+
+    constexpr bool parseSimpleNumExpr() {
+        switch (current.type) {
+        case TokenType::ID:
+            loadOperand();
+            scanToken();
+            return true;
+        case TokenType::INT_NUM:
+            if (checkTarget && targetType() == IrType::CHAR_TYPE) {
+                semantic(EmbeddedError::TYPE_MISMATCH, statementLine);
+            }
+            if (current.outOfRange) {
+                error(EmbeddedError::INTEGER_OUT_OF_RANGE);
+                return true;
+            }
+            emit(OpCode::PUSH_INT, current.intValue, statementLine);
+            scanToken();
+            return true;
+        case TokenType::LPAREN:
+            scanToken();
+            parseNumExpr();
+            if (!failed && current.type != TokenType::RPAREN) {
+                error(EmbeddedError::EXPECTED_RPAREN);
+            }
+            if (!failed) {
+                scanToken();
+            }
+            return true;
+        case TokenType::ERROR:
+            error(EmbeddedError::INVALID_TOKEN);
+            return false;
+        default:
+            error(EmbeddedError::EXPECTED_OPERAND);
+            return false;
+        }
+    }
+
+    constexpr void parseNumExpr() {
+        if (!parseSimpleNumExpr()) {
+            return;
+        }
+        while (!failed && (current.type == TokenType::PLUS || current.type == TokenType::MINUS)) {
+            OpCode op = current.type == TokenType::MINUS ? OpCode::SUB : targetType() == IrType::CHAR_TYPE ? OpCode::CONCAT : OpCode::ADD;
+            scanToken();
+            if (!parseSimpleNumExpr()) {
+                return;
+            }
+            emit(op, 0, statementLine);
+        }
+    }
+
+    constexpr void pushString() {
+        program.strings[program.stringCount] = EmbeddedSpan{ current.text.offset + 1, current.text.length - 2 };
+        emit(OpCode::PUSH_STR, program.stringCount++, statementLine);
+        scanToken();
+    }
+
+    constexpr void parseSimpleStringExpr() {
+        if (current.type == TokenType::CHAR_CONST) {
+            pushString();
+        }
+        else if (current.type == TokenType::ERROR) {
+            error(EmbeddedError::INVALID_TOKEN);
+        }
+        else {
+            error(EmbeddedError::EXPECTED_STRING);
+        }
+    }
+
+    constexpr void parseStringExpr() {
+        parseSimpleStringExpr();
+        while (!failed && current.type == TokenType::PLUS) {
+            scanToken();
+            parseSimpleStringExpr();
+            emit(OpCode::CONCAT, 0, statementLine);
+        }
+    }
+
+    constexpr void parseOp() {
+        if (current.type != TokenType::ID) {
+            error(EmbeddedError::EXPECTED_ASSIGNMENT_TARGET);
+            return;
+        }
+        EmbeddedSpan targetName = current.text;
+        statementLine = current.line;
+        int symbol = findSymbol(targetName);
+        if (symbol == NO_SYMBOL) {
+            semantic(EmbeddedError::UNDECLARED_VARIABLE, current.line);
+        }
+        checkTarget = symbol >= 0;
+        scanToken();
+        if (current.type != TokenType::ASSIGN) {
+            error(EmbeddedError::EXPECTED_ASSIGN);
+            return;
+        }
+        scanToken();
+        targetVariable = lookupVariable(targetName, current.type == TokenType::CHAR_CONST ? IrType::CHAR_TYPE : IrType::INT_TYPE);
+        if (current.type == TokenType::CHAR_CONST) {
+            parseStringExpr();
+            if (checkTarget && targetType() == IrType::INT_TYPE) {
+                semantic(EmbeddedError::TYPE_MISMATCH, statementLine);
+            }
+        }
+        else {
+            parseNumExpr();
+        }
+        if (failed) {
+            return;
+        }
+        program.variables[targetVariable].assigned = true;
+        emit(targetType() == IrType::CHAR_TYPE ? OpCode::STORE_STR : OpCode::STORE_INT, targetVariable, statementLine);
+        endStatement();
+        match(TokenType::SEMICOLON);
+    }
+
+    constexpr void parseEnd() {
+        if (current.type != TokenType::RETURN) {
+            error(EmbeddedError::EXPECTED_RETURN);
+            return;
+        }
+        scanToken();
+        if (current.type != TokenType::ID) {
+            error(EmbeddedError::EXPECTED_RETURN_IDENTIFIER);
+            return;
+        }
+        statementLine = current.line;
+        int symbol = findSymbol(current.text);
+        if (symbol == NO_SYMBOL) {
+            semantic(EmbeddedError::UNDECLARED_RETURN, current.line);
+        }
+        else if (symbol == FUNCTION_SYMBOL) {
+            semantic(EmbeddedError::RETURN_FUNCTION, current.line);
+        }
+        else if (program.variables[symbol].type != program.functionType) {
+            semantic(EmbeddedError::RETURN_TYPE_MISMATCH, current.line);
+        }
+        int variable = lookupVariable(current.text, program.functionType);
+        program.variables[variable].read = true;
+        emit(program.variables[variable].type == IrType::CHAR_TYPE ? OpCode::LOAD_STR : OpCode::LOAD_INT, variable, statementLine);
+        emit(program.functionType == IrType::CHAR_TYPE ? OpCode::RETURN_STR : OpCode::RETURN_INT, 0, statementLine);
+        endStatement();
+        scanToken();
+        match(TokenType::SEMICOLON);
+        match(TokenType::RBRACE);
+    }
+
+    constexpr void put(char c) {
+        program.text[program.textSize++] = c;
+    }
+
+    constexpr void put(const char* text) {
+        for (size_t i = 0; text[i] != '\0'; i++) {
+            put(text[i]);
+        }
+    }
+
+    constexpr void put(std::string_view text) {
+        for (char c : text) {
+            put(c);
+        }
+    }
+
+    constexpr void putInt(long long value) {
+        char digits[24] = {};
+        int count = 0;
+        unsigned long long magnitude = value < 0 ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+        do {
+            digits[count++] = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+        if (value < 0) {
+            put('-');
+        }
+        while (count > 0) {
+            put(digits[--count]);
+        }
+    }
+
+    constexpr void putInstruction(const EmbeddedInstruction& instr) {
+        switch (instr.op) {
+        case OpCode::PUSH_INT:
+            putInt(instr.operand);
+            break;
+        case OpCode::PUSH_STR:
+            put('"');
+            put(program.spanText(program.strings[instr.operand]));
+            put('"');
+            break;
+        case OpCode::LOAD_INT:
+        case OpCode::LOAD_STR:
+            put(program.spanText(program.variables[instr.operand].name));
+            break;
+        case OpCode::STORE_INT:
+        case OpCode::STORE_STR:
+            put(program.spanText(program.variables[instr.operand].name));
+            put(" =");
+            break;
+        case OpCode::ADD:
+        case OpCode::CONCAT:
+            put('+');
+            break;
+        case OpCode::SUB:
+            put('-');
+            break;
+        default:
+            put("RETURN");
+            break;
+        }
+    }
+
+    constexpr void writePostfix() {
+        put("\n=== POSTFIX NOTATION ===\n");
+        for (int d = 0; d < program.declCount; d++) {
+            const EmbeddedDeclGroup& group = program.decls[d];
+            int live = 0;
+            for (int i = group.first; i < group.first + group.count; i++) {
+                const EmbeddedVariable& variable = program.variables[i];
+                if (variable.read || variable.assigned) {
+                    live++;
+                }
+            }
+            if (live == 0) {
+                continue;
+            }
+            put(group.type == IrType::CHAR_TYPE ? "char" : "int");
+            for (int i = group.first; i < group.first + group.count; i++) {
+                const EmbeddedVariable& variable = program.variables[i];
+                if (variable.read || variable.assigned) {
+                    put(' ');
+                    put(program.spanText(variable.name));
+                }
+            }
+            put(' ');
+            putInt(live + 1);
+            put(" decl\n");
+        }
+        int pc = 0;
+        for (int s = 0; s < program.statementCount; s++) {
+            for (; pc < program.statementEnds[s]; pc++) {
+                putInstruction(program.code[pc]);
+                put(pc + 1 == program.statementEnds[s] ? '\n' : ' ');
+            }
+        }
+    }
+
+public:
+    constexpr EmbeddedCompiler(EmbeddedProgram<N>& p, std::string_view text)
+        : program(p), length(text.size()), cursor(0), currentLine(1), lineStart(0), statementLine(0), targetVariable(0), checkTarget(false), failed(false) {
+        for (size_t i = 0; i < length && i < N; i++) {
+            program.source[i] = text[i];
+        }
+    }
+
+    constexpr void compile() {
+        if (length > N) {
+            program.diag.error = EmbeddedError::TOO_LARGE;
+            return;
+        }
+        scanToken();
+        parseBegin();
+        while (!failed && (current.type == TokenType::INT || current.type == TokenType::CHAR)) {
+            parseDescr();
+        }
+        while (!failed && (current.type == TokenType::ID || current.type == TokenType::ASSIGN)) {
+            parseOp();
+        }
+        if (!failed) {
+            parseEnd();
+        }
+        if (failed) {
+            program.diag = syntaxError;
+            return;
+        }
+        if (semanticError.error != EmbeddedError::NONE) {
+            program.diag = semanticError;
+            return;
+        }
+        writePostfix();
+    }
+};
+
+template <size_t N>
+constexpr EmbeddedProgram<N> compileEmbedded(std::string_view source) {
+    EmbeddedProgram<N> program;
+    EmbeddedCompiler<N> compiler(program, source);
+    compiler.compile();
+    return program;
+}
+
+template <size_t N>
+constexpr EmbeddedProgram<N> compileEmbedded(const char (&source)[N]) {
+    return compileEmbedded<N>(std::string_view(source, N - 1));
+}
+
+template <size_t N>
+struct EmbeddedSource {
+    char text[N] = {};
+    constexpr EmbeddedSource(const char (&source)[N]) {
+        for (size_t i = 0; i < N; i++) {
+            text[i] = source[i];
+        }
+    }
+};
+
+template <EmbeddedError Error, int Line, int Position, TokenType Expected>
+struct EmbeddedCompileError;
+
+template <EmbeddedError Error, int Line, int Position, TokenType Expected>
+constexpr bool embeddedCompileCheck() {
+    if constexpr (Error != EmbeddedError::NONE) {
+        return sizeof(EmbeddedCompileError<Error, Line, Position, Expected>) == 0;
+    }
+    else {
+        return true;
+    }
+}
+
+template <EmbeddedSource Source>
+struct EmbeddedUnit {
+    static constexpr EmbeddedProgram<sizeof(Source.text)> program = compileEmbedded(Source.text);
+    static constexpr EmbeddedDiagnostic diagnostic = program.diagnostic();
+    static_assert(embeddedCompileCheck<diagnostic.error, diagnostic.line, diagnostic.position, diagnostic.expected>(),
+        "embedded program does not compile");
+};
+
+template <EmbeddedSource Source>
+inline constexpr const auto& embeddedProgram = EmbeddedUnit<Source>::program;
+
+#endif
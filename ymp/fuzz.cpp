@@ -0,0 +1,60 @@
+#include "complexity.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+namespace {
+
+const int COST_BUCKETS = 40;
+const int COST_PHASES = static_cast<int>(AllocPhase::COUNT) + 3;
+
+#if defined(__clang__) || defined(__GNUC__)
+__attribute__((used, section("__libfuzzer_extra_counters")))
+#endif
+uint8_t costCounters[COST_PHASES * COST_BUCKETS];
+
+ComplexityProbe* probe = nullptr;
+std::string slowestDirectory;
+
+int costBucket(long long cost) {
+    int bucket = 0;
+    while (cost > 1 && bucket < COST_BUCKETS - 1) {
+        cost >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void markCost(int phase, long long cost) {
+    costCounters[phase * COST_BUCKETS + costBucket(cost)] = 1;
+}
+
+}
+
+extern "C" int LLVMFuzzerInitialize(int*, char***) {
+    static ComplexityProbe instance;
+    probe = &instance;
+    const char* directory = std::getenv("YMP_FUZZ_SLOWEST");
+    if (directory != nullptr) {
+        slowestDirectory = directory;
+    }
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::string_view source(reinterpret_cast<const char*>(data), size);
+    bool slower = probe->record(source);
+    const ComplexityMeasurement& measurement = probe->getMeasurement();
+    markCost(0, measurement.ns >> 10);
+    markCost(1, measurement.allocations);
+    markCost(2, measurement.peakBytes);
+    for (int i = 0; i < static_cast<int>(AllocPhase::COUNT); i++) {
+        markCost(i + 3, measurement.phaseAllocations[i]);
+    }
+    if (slower && !slowestDirectory.empty()) {
+        probe->writeSlowest(slowestDirectory);
+    }
+    return 0;
+}
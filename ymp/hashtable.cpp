@@ -5,14 +5,14 @@
 HashEntry::HashEntry(const Token& t, int idx)
     : token(t), index(idx), next(nullptr) {
 }
-HashTable::HashTable() : currentIndex(0) {
-    table = new HashEntry * [TABLE_SIZE];
-    for (int i = 0; i < TABLE_SIZE; i++) {
+HashTable::HashTable() : tableSize(INITIAL_SIZE), currentIndex(0) {
+    table = new HashEntry * [tableSize];
+    for (int i = 0; i < tableSize; i++) {
         table[i] = nullptr;
     }
 }
 HashTable::~HashTable() {
-    for (int i = 0; i < TABLE_SIZE; i++) {
+    for (int i = 0; i < tableSize; i++) {
         HashEntry* entry = table[i];
         while (entry != nullptr) {
             HashEntry* temp = entry;
@@ -23,11 +23,32 @@ HashTable::~HashTable() {
     delete[] table;
 }
 int HashTable::hash(const std::string& value) const {
-    int hash = 0;
+    unsigned int hash = 0;
     for (char c : value) {
-        hash = (hash * 257 + c) % TABLE_SIZE;
+        hash = hash * 257 + static_cast<unsigned char>(c);
     }
-    return hash;
+    return static_cast<int>(hash & static_cast<unsigned int>(tableSize - 1));
+}
+
+void HashTable::grow() {
+    HashEntry** oldTable = table;
+    int oldSize = tableSize;
+    tableSize *= 2;
+    table = new HashEntry * [tableSize];
+    for (int i = 0; i < tableSize; i++) {
+        table[i] = nullptr;
+    }
+    for (int i = 0; i < oldSize; i++) {
+        HashEntry* entry = oldTable[i];
+        while (entry != nullptr) {
+            HashEntry* next = entry->next;
+            int hashValue = hash(entry->token.value);
+            entry->next = table[hashValue];
+            table[hashValue] = entry;
+            entry = next;
+        }
+    }
+    delete[] oldTable;
 }
 int HashTable::insert(const Token& token) {
     int hashValue = hash(token.value);
@@ -38,6 +59,10 @@ int HashTable::insert(const Token& token) {
         }
         entry = entry->next;
     }
+    if (currentIndex >= tableSize) {
+        grow();
+        hashValue = hash(token.value);
+    }
     HashEntry* newEntry = new HashEntry(token, currentIndex);
     newEntry->next = table[hashValue];
     table[hashValue] = newEntry;
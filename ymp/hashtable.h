@@ -11,10 +11,12 @@ struct HashEntry {
 
 class HashTable {
 private:
-    static const int TABLE_SIZE = 100;
+    static const int INITIAL_SIZE = 128;
     HashEntry** table;
+    int tableSize;
     int currentIndex;
     int hash(const std::string& value) const;
+    void grow();
 public:
     HashTable();
     ~HashTable();
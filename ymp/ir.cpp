@@ -0,0 +1,446 @@
+#include "ir.h"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+struct ExprKey {
+    IrOp op;
+    IrOperand a;
+    IrOperand b;
+    bool operator==(const ExprKey& other) const {
+        return op == other.op && a == other.a && b == other.b;
+    }
+};
+
+struct ExprKeyHash {
+    size_t operator()(const ExprKey& key) const {
+        size_t h = static_cast<size_t>(key.op);
+        h = h * 31 + static_cast<size_t>(key.a.kind);
+        h = h * 1000003 + static_cast<size_t>(key.a.index);
+        h = h * 31 + static_cast<size_t>(key.b.kind);
+        h = h * 1000003 + static_cast<size_t>(key.b.index);
+        return h;
+    }
+};
+
+bool operandLess(const IrOperand& x, const IrOperand& y) {
+    return x.kind != y.kind ? x.kind < y.kind : x.index < y.index;
+}
+
+bool isArithmetic(IrOp op) {
+    return op == IrOp::ADD || op == IrOp::SUB || op == IrOp::CONCAT;
+}
+
+}
+
+IrOperand::IrOperand(IrOperandKind k, int i) : kind(k), index(i) {
+}
+
+bool IrOperand::operator==(const IrOperand& other) const {
+    return kind == other.kind && index == other.index;
+}
+
+IrInstr::IrInstr(IrOp o, int r, IrOperand x, IrOperand y, int l)
+    : op(o), result(r), a(x), b(y), line(l), dead(false) {
+}
+
+IrVariable::IrVariable(const std::string& n, IrType t, bool d, int l) : name(n), type(t), declared(d), dead(false), line(l) {
+}
+
+IrVersion::IrVersion(int v, int n) : variable(v), number(n) {
+}
+
+IrLiteral::IrLiteral(const std::string& t, int v) : text(t), value(v) {
+}
+
+IrFunction::IrFunction() : returnType(IrType::INT_TYPE), tempCount(0) {
+}
+
+void IrFunction::clear() {
+    name.clear();
+    returnType = IrType::INT_TYPE;
+    variables.clear();
+    versions.clear();
+    decls.clear();
+    code.clear();
+    literals.clear();
+    tempCount = 0;
+}
+
+int IrFunction::variableOf(const IrOperand& operand) const {
+    if (operand.kind != IrOperandKind::VERSION) return -1;
+    return versions[operand.index].variable;
+}
+
+IrBuilder::IrBuilder() : function(nullptr) {
+}
+
+IrFunction IrBuilder::build(const std::shared_ptr<ParseTreeNode>& root) {
+    IrFunction result;
+    build(root, result);
+    return result;
+}
+
+// Lowers into an existing function so a caller that compiles repeatedly keeps
+// the capacity of its vectors.
+void IrBuilder::build(const std::shared_ptr<ParseTreeNode>& root, IrFunction& result) {
+    result.clear();
+    function = &result;
+    variableIds.clear();
+    lexemeVariables.clear();
+    currentVersion.clear();
+    if (root && root->name == "Function") {
+        for (const auto& child : root->children) {
+            if (child->name == "Begin" && child->children.size() >= 2) {
+                const ParseTreeNode& typeNode = *child->children[0];
+                if (!typeNode.children.empty() && typeNode.children[0]->token.type == TokenType::CHAR) {
+                    result.returnType = IrType::CHAR_TYPE;
+                }
+                const ParseTreeNode& nameNode = *child->children[1];
+                if (!nameNode.children.empty()) {
+                    result.name = nameNode.children[0]->token.value;
+                }
+            }
+            else if (child->name == "Descriptions") {
+                lowerDescriptions(*child);
+            }
+            else if (child->name == "Operators") {
+                for (const auto& op : child->children) {
+                    if (op->name == "Op") {
+                        lowerOp(*op);
+                    }
+                }
+            }
+            else if (child->name == "End") {
+                lowerEnd(*child);
+            }
+        }
+    }
+    function = nullptr;
+}
+
+void IrBuilder::lowerDescriptions(const ParseTreeNode& descNode) {
+    for (const auto& descr : descNode.children) {
+        if (descr->name != "Descr" || descr->children.size() < 2) continue;
+        const ParseTreeNode& typeNode = *descr->children[0];
+        IrDeclGroup group;
+        group.type = IrType::INT_TYPE;
+        if (typeNode.name == "Type" && !typeNode.children.empty() && typeNode.children[0]->token.value == "char") {
+            group.type = IrType::CHAR_TYPE;
+        }
+        for (const auto& var : descr->children[1]->children) {
+            if (var->name != "Id") continue;
+            int id = static_cast<int>(function->variables.size());
+            function->variables.emplace_back(var->token.value, group.type, true, var->token.line);
+            currentVersion.push_back(-1);
+            variableIds.emplace(var->token.value, id);
+            group.variables.push_back(id);
+        }
+        if (!group.variables.empty()) {
+            function->decls.push_back(group);
+        }
+    }
+}
+
+// Names the analyzer reports as undeclared still get an entry so the postfix
+// of a rejected program can print them; such programs never reach a backend.
+int IrBuilder::lookupVariable(const std::string& name, IrType implicitType) {
+    auto it = variableIds.find(name);
+    if (it != variableIds.end()) {
+        return it->second;
+    }
+    int id = static_cast<int>(function->variables.size());
+    function->variables.emplace_back(name, implicitType, false);
+    currentVersion.push_back(-1);
+    variableIds.emplace(name, id);
+    return id;
+}
+
+// Every expression of one parse shares a LexemeTable, so a variable found
+// once by name is found again by lexeme id without hashing the name.
+int IrBuilder::lookupOperand(const ExprCode& code, const ExprOp& op, IrType implicitType) {
+    if (static_cast<size_t>(op.operand) >= lexemeVariables.size()) {
+        lexemeVariables.resize(code.lexemes->size(), -1);
+    }
+    int& variable = lexemeVariables[op.operand];
+    if (variable < 0) {
+        variable = lookupVariable(code.text(op), implicitType);
+    }
+    return variable;
+}
+
+int IrBuilder::newVersion(int variable) {
+    int number = 1;
+    if (currentVersion[variable] >= 0) {
+        number = function->versions[currentVersion[variable]].number + 1;
+    }
+    int id = static_cast<int>(function->versions.size());
+    function->versions.emplace_back(variable, number);
+    currentVersion[variable] = id;
+    return id;
+}
+
+int IrBuilder::addLiteral(const std::string& text, int value) {
+    function->literals.emplace_back(text, value);
+    return static_cast<int>(function->literals.size()) - 1;
+}
+
+IrOperand IrBuilder::readVariable(int variable) {
+    if (currentVersion[variable] < 0) {
+        currentVersion[variable] = static_cast<int>(function->versions.size());
+        function->versions.emplace_back(variable, 0);
+    }
+    return IrOperand(IrOperandKind::VERSION, currentVersion[variable]);
+}
+
+IrOperand IrBuilder::lowerExpr(const ExprCode& code, IrType type) {
+    operandStack.clear();
+    for (const ExprOp& op : code.ops) {
+        switch (op.kind) {
+        case ExprOpKind::ID:
+            operandStack.push_back(readVariable(lookupOperand(code, op, type)));
+            break;
+        case ExprOpKind::CONST:
+            operandStack.push_back(IrOperand(IrOperandKind::INT_CONST, addLiteral(std::to_string(op.value), op.value)));
+            break;
+        case ExprOpKind::STRING:
+            operandStack.push_back(IrOperand(IrOperandKind::STR_CONST, addLiteral(code.text(op), 0)));
+            break;
+        case ExprOpKind::ADD:
+        case ExprOpKind::SUB: {
+            if (operandStack.size() < 2) break;
+            IrOperand right = operandStack.back();
+            operandStack.pop_back();
+            IrOperand left = operandStack.back();
+            IrOp irOp = IrOp::ADD;
+            if (op.kind == ExprOpKind::SUB) {
+                irOp = IrOp::SUB;
+            }
+            else if (type == IrType::CHAR_TYPE) {
+                irOp = IrOp::CONCAT;
+            }
+            int temp = function->tempCount++;
+            function->code.emplace_back(irOp, temp, left, right, op.line);
+            operandStack.back() = IrOperand(IrOperandKind::TEMP, temp);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return operandStack.empty() ? IrOperand() : operandStack.front();
+}
+
+void IrBuilder::lowerOp(const ParseTreeNode& opNode) {
+    if (opNode.children.size() < 2 || opNode.children[0]->name != "Id") return;
+    const Token& target = opNode.children[0]->token;
+    const ParseTreeNode& exprNode = *opNode.children[1];
+    IrType implicitType = exprNode.name == "StringExpr" ? IrType::CHAR_TYPE : IrType::INT_TYPE;
+    int variable = lookupVariable(target.value, implicitType);
+    IrOperand value;
+    if (exprNode.code) {
+        value = lowerExpr(*exprNode.code, function->variables[variable].type);
+    }
+    int version = newVersion(variable);
+    function->code.emplace_back(IrOp::DEF, version, value, IrOperand(), target.line);
+}
+
+void IrBuilder::lowerEnd(const ParseTreeNode& endNode) {
+    if (endNode.children.empty() || endNode.children[0]->name != "Id") return;
+    const Token& value = endNode.children[0]->token;
+    IrOperand operand = readVariable(lookupVariable(value.value, function->returnType));
+    function->code.emplace_back(IrOp::RETURN, -1, operand, IrOperand(), value.line);
+}
+
+void IrOptimizer::run(IrFunction& function) {
+    propagateCopies(function);
+    eliminateDeadStores(function);
+    eliminateCommonSubexpressions(function);
+    removeUnusedDeclarations(function);
+}
+
+// Copies and constants flow forward in one pass. An ADD or SUB whose operands
+// are both constants by then is folded with the VM's wrap-around arithmetic
+// and its temp is replaced by the result, which can then flow on in turn.
+void IrOptimizer::propagateCopies(IrFunction& function) {
+    std::vector<int> current(function.variables.size(), -1);
+    for (size_t i = 0; i < function.versions.size(); i++) {
+        if (function.versions[i].number == 0) {
+            current[function.versions[i].variable] = static_cast<int>(i);
+        }
+    }
+    std::vector<IrOperand> copyOf(function.versions.size());
+    std::vector<IrOperand> foldedTemps(function.tempCount);
+    auto resolve = [&](IrOperand operand) {
+        if (operand.kind == IrOperandKind::TEMP && foldedTemps[operand.index].kind == IrOperandKind::INT_CONST) {
+            return foldedTemps[operand.index];
+        }
+        while (operand.kind == IrOperandKind::VERSION) {
+            const IrOperand& source = copyOf[operand.index];
+            if (source.kind == IrOperandKind::INT_CONST || source.kind == IrOperandKind::STR_CONST) {
+                return source;
+            }
+            if (source.kind != IrOperandKind::VERSION || current[function.variableOf(source)] != source.index) {
+                break;
+            }
+            operand = source;
+        }
+        return operand;
+    };
+    for (IrInstr& instr : function.code) {
+        instr.a = resolve(instr.a);
+        instr.b = resolve(instr.b);
+        if ((instr.op == IrOp::ADD || instr.op == IrOp::SUB) && instr.a.kind == IrOperandKind::INT_CONST && instr.b.kind == IrOperandKind::INT_CONST) {
+            uint32_t left = static_cast<uint32_t>(function.literals[instr.a.index].value);
+            uint32_t right = static_cast<uint32_t>(function.literals[instr.b.index].value);
+            int value = static_cast<int>(instr.op == IrOp::ADD ? left + right : left - right);
+            function.literals.emplace_back(std::to_string(value), value);
+            foldedTemps[instr.result] = IrOperand(IrOperandKind::INT_CONST, static_cast<int>(function.literals.size()) - 1);
+            instr.dead = true;
+            continue;
+        }
+        if (instr.op == IrOp::DEF) {
+            if (instr.a.kind != IrOperandKind::TEMP) {
+                copyOf[instr.result] = instr.a;
+            }
+            current[function.versions[instr.result].variable] = instr.result;
+        }
+    }
+    function.code.erase(std::remove_if(function.code.begin(), function.code.end(),
+        [](const IrInstr& instr) { return instr.dead; }), function.code.end());
+}
+
+void IrOptimizer::eliminateDeadStores(IrFunction& function) {
+    std::vector<bool> liveVersions(function.versions.size(), false);
+    std::vector<bool> liveTemps(function.tempCount, false);
+    auto markLive = [&](const IrOperand& operand) {
+        if (operand.kind == IrOperandKind::VERSION) {
+            liveVersions[operand.index] = true;
+        }
+        else if (operand.kind == IrOperandKind::TEMP) {
+            liveTemps[operand.index] = true;
+        }
+    };
+    for (auto it = function.code.rbegin(); it != function.code.rend(); ++it) {
+        IrInstr& instr = *it;
+        bool live = true;
+        if (instr.op == IrOp::DEF) {
+            live = liveVersions[instr.result];
+        }
+        else if (instr.op != IrOp::RETURN) {
+            live = liveTemps[instr.result];
+        }
+        if (!live) {
+            instr.dead = true;
+            continue;
+        }
+        markLive(instr.a);
+        markLive(instr.b);
+    }
+    function.code.erase(std::remove_if(function.code.begin(), function.code.end(),
+        [](const IrInstr& instr) { return instr.dead; }), function.code.end());
+}
+
+void IrOptimizer::eliminateCommonSubexpressions(IrFunction& function) {
+    // A string literal is stored without its quotes, so "1" and 1 have the
+    // same text; integers and strings are numbered in separate tables.
+    std::unordered_map<std::string, int> literalIds[2];
+    std::vector<int> canonicalLiteral(function.literals.size(), -1);
+    std::vector<IrOperand> replacement(function.tempCount);
+    std::unordered_map<ExprKey, int, ExprKeyHash> available;
+    auto canonical = [&](IrOperand operand) {
+        if (operand.kind == IrOperandKind::INT_CONST || operand.kind == IrOperandKind::STR_CONST) {
+            int& id = canonicalLiteral[operand.index];
+            if (id < 0) {
+                id = literalIds[operand.kind == IrOperandKind::STR_CONST].emplace(function.literals[operand.index].text, operand.index).first->second;
+            }
+            operand.index = id;
+        }
+        else if (operand.kind == IrOperandKind::TEMP && replacement[operand.index].kind == IrOperandKind::TEMP) {
+            operand = replacement[operand.index];
+        }
+        return operand;
+    };
+    for (IrInstr& instr : function.code) {
+        instr.a = canonical(instr.a);
+        instr.b = canonical(instr.b);
+        if (!isArithmetic(instr.op)) continue;
+        ExprKey key{ instr.op, instr.a, instr.b };
+        if (instr.op == IrOp::ADD && operandLess(key.b, key.a)) {
+            std::swap(key.a, key.b);
+        }
+        auto found = available.emplace(key, instr.result);
+        if (!found.second) {
+            replacement[instr.result] = IrOperand(IrOperandKind::TEMP, found.first->second);
+            instr.dead = true;
+        }
+    }
+    function.code.erase(std::remove_if(function.code.begin(), function.code.end(),
+        [](const IrInstr& instr) { return instr.dead; }), function.code.end());
+
+    std::vector<int> uses(function.tempCount, 0);
+    for (const IrInstr& instr : function.code) {
+        if (instr.a.kind == IrOperandKind::TEMP) uses[instr.a.index]++;
+        if (instr.b.kind == IrOperandKind::TEMP) uses[instr.b.index]++;
+    }
+    std::vector<IrOperand> spilled(function.tempCount);
+    std::vector<int> cost(function.tempCount, 0);
+    IrDeclGroup intTemps;
+    intTemps.type = IrType::INT_TYPE;
+    IrDeclGroup charTemps;
+    charTemps.type = IrType::CHAR_TYPE;
+    std::vector<IrInstr> code;
+    code.reserve(function.code.size());
+    for (IrInstr& instr : function.code) {
+        if (instr.a.kind == IrOperandKind::TEMP && spilled[instr.a.index].kind == IrOperandKind::VERSION) {
+            instr.a = spilled[instr.a.index];
+        }
+        if (instr.b.kind == IrOperandKind::TEMP && spilled[instr.b.index].kind == IrOperandKind::VERSION) {
+            instr.b = spilled[instr.b.index];
+        }
+        code.push_back(instr);
+        if (!isArithmetic(instr.op)) continue;
+        cost[instr.result] = 1 + (instr.a.kind == IrOperandKind::TEMP ? cost[instr.a.index] : 0)
+            + (instr.b.kind == IrOperandKind::TEMP ? cost[instr.b.index] : 0);
+        if (uses[instr.result] < 2 || cost[instr.result] < 2) continue;
+        IrType type = instr.op == IrOp::CONCAT ? IrType::CHAR_TYPE : IrType::INT_TYPE;
+        int variable = static_cast<int>(function.variables.size());
+        size_t tempNumber = intTemps.variables.size() + charTemps.variables.size();
+        function.variables.emplace_back("_t" + std::to_string(tempNumber), type, true, instr.line);
+        int version = static_cast<int>(function.versions.size());
+        function.versions.emplace_back(variable, 1);
+        code.emplace_back(IrOp::DEF, version, IrOperand(IrOperandKind::TEMP, instr.result), IrOperand(), instr.line);
+        spilled[instr.result] = IrOperand(IrOperandKind::VERSION, version);
+        (type == IrType::CHAR_TYPE ? charTemps : intTemps).variables.push_back(variable);
+    }
+    function.code.swap(code);
+    if (!intTemps.variables.empty()) {
+        function.decls.push_back(intTemps);
+    }
+    if (!charTemps.variables.empty()) {
+        function.decls.push_back(charTemps);
+    }
+}
+
+void IrOptimizer::removeUnusedDeclarations(IrFunction& function) {
+    std::vector<bool> used(function.variables.size(), false);
+    for (const IrInstr& instr : function.code) {
+        if (instr.op == IrOp::DEF) {
+            used[function.versions[instr.result].variable] = true;
+        }
+        if (instr.a.kind == IrOperandKind::VERSION) {
+            used[function.variableOf(instr.a)] = true;
+        }
+        if (instr.b.kind == IrOperandKind::VERSION) {
+            used[function.variableOf(instr.b)] = true;
+        }
+    }
+    for (IrDeclGroup& group : function.decls) {
+        group.variables.erase(std::remove_if(group.variables.begin(), group.variables.end(),
+            [&](int variable) { return !used[variable]; }), group.variables.end());
+    }
+    function.decls.erase(std::remove_if(function.decls.begin(), function.decls.end(),
+        [](const IrDeclGroup& group) { return group.variables.empty(); }), function.decls.end());
+}
@@ -0,0 +1,120 @@
+#ifndef IR_H
+#define IR_H
+
+#include "parser.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class IrType {
+    INT_TYPE,
+    CHAR_TYPE
+};
+
+enum class IrOp {
+    ADD,
+    SUB,
+    CONCAT,
+    DEF,
+    RETURN
+};
+
+enum class IrOperandKind {
+    NONE,
+    TEMP,
+    VERSION,
+    INT_CONST,
+    STR_CONST
+};
+
+struct IrOperand {
+    IrOperandKind kind;
+    int index;
+    IrOperand(IrOperandKind k = IrOperandKind::NONE, int i = -1);
+    bool operator==(const IrOperand& other) const;
+};
+
+struct IrInstr {
+    IrOp op;
+    int result;
+    IrOperand a;
+    IrOperand b;
+    int line;
+    bool dead;
+    IrInstr(IrOp o, int r, IrOperand x, IrOperand y, int l);
+};
+
+struct IrVariable {
+    std::string name;
+    IrType type;
+    bool declared;
+    bool dead;
+    int line;
+    IrVariable(const std::string& n, IrType t, bool d, int l = 0);
+};
+
+struct IrVersion {
+    int variable;
+    int number;
+    IrVersion(int v, int n);
+};
+
+struct IrLiteral {
+    std::string text;
+    int value;
+    IrLiteral(const std::string& t, int v);
+};
+
+struct IrDeclGroup {
+    IrType type;
+    std::vector<int> variables;
+};
+
+struct IrFunction {
+    std::string name;
+    IrType returnType;
+    std::vector<IrVariable> variables;
+    std::vector<IrVersion> versions;
+    std::vector<IrDeclGroup> decls;
+    std::vector<IrInstr> code;
+    std::vector<IrLiteral> literals;
+    int tempCount;
+    IrFunction();
+    void clear();
+    int variableOf(const IrOperand& operand) const;
+};
+
+class IrBuilder {
+private:
+    IrFunction* function;
+    std::unordered_map<std::string, int> variableIds;
+    std::vector<int> lexemeVariables;
+    std::vector<int> currentVersion;
+    std::vector<IrOperand> operandStack;
+    int lookupVariable(const std::string& name, IrType implicitType);
+    int lookupOperand(const ExprCode& code, const ExprOp& op, IrType implicitType);
+    int newVersion(int variable);
+    int addLiteral(const std::string& text, int value);
+    IrOperand readVariable(int variable);
+    IrOperand lowerExpr(const ExprCode& code, IrType type);
+    void lowerDescriptions(const ParseTreeNode& descNode);
+    void lowerOp(const ParseTreeNode& opNode);
+    void lowerEnd(const ParseTreeNode& endNode);
+public:
+    IrBuilder();
+    IrFunction build(const std::shared_ptr<ParseTreeNode>& root);
+    void build(const std::shared_ptr<ParseTreeNode>& root, IrFunction& result);
+};
+
+class IrOptimizer {
+private:
+    void propagateCopies(IrFunction& function);
+    void eliminateDeadStores(IrFunction& function);
+    void eliminateCommonSubexpressions(IrFunction& function);
+    void removeUnusedDeclarations(IrFunction& function);
+public:
+    void run(IrFunction& function);
+};
+
+#endif
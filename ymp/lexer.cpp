@@ -1,103 +1,215 @@
 #include "lexer.h"
-#include <iostream>
-#include <cctype>
+#include "alloctrack.h"
+#include <charconv>
+#include <fstream>
+#include <iterator>
 
-Lexer::Lexer(const std::string& inputFilename) : currentLine(1), currentPos(0) {
-    inputFile.open(inputFilename);
+namespace {
+
+enum CharClass : unsigned char {
+    SPACE = 1,
+    ALPHA = 2,
+    DIGIT = 4,
+    DELIMITER = 8
+};
+
+struct CharTable {
+    unsigned char classes[256];
+    constexpr CharTable() : classes() {
+        for (int c = 'a'; c <= 'z'; c++) {
+            classes[c] = ALPHA;
+            classes[c - 'a' + 'A'] = ALPHA;
+        }
+        for (int c = '0'; c <= '9'; c++) {
+            classes[c] = DIGIT;
+        }
+        for (const char* c = " \t\n\v\f\r"; *c != '\0'; c++) {
+            classes[static_cast<unsigned char>(*c)] = SPACE | DELIMITER;
+        }
+        for (const char* c = "+-=(){},;\"/"; *c != '\0'; c++) {
+            classes[static_cast<unsigned char>(*c)] = DELIMITER;
+        }
+        classes[0] = DELIMITER;
+    }
+};
+
+constexpr CharTable charTable;
+
+inline unsigned char classOf(char c) {
+    return charTable.classes[static_cast<unsigned char>(c)];
+}
+
+}
+
+Lexer::Lexer(const std::string& inputFilename) : currentLine(1), currentPos(0), asciiOnly(false) {
+    std::ifstream inputFile(inputFilename);
+    ownedSource.assign(std::istreambuf_iterator<char>(inputFile), std::istreambuf_iterator<char>());
+    cursor = ownedSource.data();
+    begin = cursor;
+    end = cursor + ownedSource.size();
+    nextChar();
+}
+
+Lexer::Lexer(const char* data, size_t size) : begin(data), cursor(data), end(data + size), currentLine(1), currentPos(0), asciiOnly(false) {
     nextChar();
 }
 
-Lexer::~Lexer() {
-    if (inputFile.is_open()) inputFile.close();
+void Lexer::setAsciiOnly(bool ascii) {
+    asciiOnly = ascii;
 }
 
 void Lexer::nextChar() {
-    if (inputFile.get(currentChar)) {
-        currentPos++;
+    if (cursor != end) {
+        currentChar = *cursor++;
+        if (asciiOnly || (static_cast<unsigned char>(currentChar) & 0xC0) != 0x80) {
+            currentPos++;
+        }
     }
     else {
         currentChar = '\0';
     }
 }
 
-Token Lexer::parseIdentifier() {
-    std::string value;
-    int line = currentLine;
-    int pos = currentPos;
-    while (currentChar != ' ' && currentChar != '\n' && currentChar != '\0' && !isValidSymbol(currentChar)) {
-        value += currentChar;
-        nextChar();
+int Lexer::tokenOffset() const {
+    if (cursor == end && currentChar == '\0') {
+        return static_cast<int>(end - begin);
+    }
+    return static_cast<int>(cursor - begin) - 1;
+}
+
+void Lexer::advanceTo(const char* stop) {
+    if (asciiOnly) {
+        currentPos += static_cast<int>(stop - cursor);
+    }
+    else {
+        for (const char* p = cursor; p != stop; p++) {
+            if ((static_cast<unsigned char>(*p) & 0xC0) != 0x80) {
+                currentPos++;
+            }
+        }
+    }
+    cursor = stop;
+    nextChar();
+}
+
+void Lexer::parseIdentifier(Token& out) {
+    out.line = currentLine;
+    out.position = currentPos;
+    out.offset = tokenOffset();
+    const char* stop = cursor;
+    while (stop != end && (classOf(*stop) & DELIMITER) == 0) {
+        stop++;
+    }
+    out.value.assign(cursor - 1, stop);
+    advanceTo(stop);
+    const std::string& value = out.value;
+    if (value == "return") {
+        out.type = TokenType::RETURN;
+        return;
+    }
+    if (value == "int") {
+        out.type = TokenType::INT;
+        return;
+    }
+    if (value == "char") {
+        out.type = TokenType::CHAR;
+        return;
     }
-    if (value == "return") return Token(TokenType::RETURN, value, line, pos);
-    if (value == "int") return Token(TokenType::INT, value, line, pos);
-    if (value == "char") return Token(TokenType::CHAR, value, line, pos);
     for (int i = 0; i < value.size(); ++i) {
-        if (!std::isalpha(value[i])) {
-            return Token(TokenType::ERROR, value, line, pos);
+        if ((classOf(value[i]) & ALPHA) == 0) {
+            out.type = TokenType::ERROR;
+            return;
         }
     }
-    return Token(TokenType::ID, value, line, pos);
+    out.type = TokenType::ID;
 }
 
-Token Lexer::parseNumber() {
-    std::string value;
-    int line = currentLine;
-    int pos = currentPos;
-    if (isdigit(currentChar)) {
+void Lexer::parseNumber(Token& out) {
+    std::string& value = out.value;
+    value.clear();
+    out.line = currentLine;
+    out.position = currentPos;
+    out.offset = tokenOffset();
+    out.intValue = 0;
+    out.outOfRange = false;
+    if (classOf(currentChar) & DIGIT) {
         value += currentChar;
         nextChar();
     }
-    if (value == "0" && isdigit(currentChar)) {
-        while (isdigit(currentChar)) {
+    if (value == "0" && (classOf(currentChar) & DIGIT)) {
+        while (classOf(currentChar) & DIGIT) {
             value += currentChar;
             nextChar();
         }
-        return Token(TokenType::ERROR, value, line, pos);
+        out.type = TokenType::ERROR;
+        return;
     }
-    while (isdigit(currentChar)) {
+    while (classOf(currentChar) & DIGIT) {
         value += currentChar;
         nextChar();
     }
     if (isValidSymbol(currentChar)) {
-        return Token(TokenType::INT_NUM, value, line, pos);
+        out.type = TokenType::INT_NUM;
+        parseIntValue(out);
+        return;
     }
     if (currentChar != ' ' && currentChar != '\n' && currentChar != '\0' && !isValidSymbol(currentChar)) {
         while (currentChar != ' ' && currentChar != '\n' && currentChar != '\0' && !isValidSymbol(currentChar)) {
             value += currentChar;
             nextChar();
         }
-        return Token(TokenType::ERROR, value, line, pos);
+        out.type = TokenType::ERROR;
+        return;
+    }
+    out.type = TokenType::INT_NUM;
+    parseIntValue(out);
+}
+
+void Lexer::parseIntValue(Token& out) {
+    const char* first = out.value.data();
+    const char* last = first + out.value.size();
+    std::from_chars_result result = std::from_chars(first, last, out.intValue);
+    if (result.ec == std::errc::result_out_of_range) {
+        out.intValue = 0;
+        out.outOfRange = true;
     }
-    return Token(TokenType::INT_NUM, value, line, pos);
 }
 
-Token Lexer::parseString() {
-    std::string value;
-    int line = currentLine;
-    int pos = currentPos;
+void Lexer::parseString(Token& out) {
+    std::string& value = out.value;
+    out.line = currentLine;
+    out.position = currentPos;
+    out.offset = tokenOffset();
     nextChar();
-    value = '"';
+    value.clear();
     while (currentChar != '"' && currentChar != '\0' && currentChar != '\n') {
         value += currentChar;
         nextChar();
     }
     if (currentChar == '"') {
         nextChar();
-        value = value + '"';
-        return Token(TokenType::CHAR_CONST, value, line, pos);
+        out.type = TokenType::CHAR_CONST;
     }
     else {
-        return Token(TokenType::ERROR, value, line, pos);
+        value.insert(value.begin(), '"');
+        out.type = TokenType::ERROR;
     }
 }
 
 
 bool Lexer::isValidSymbol(char c) {
-    return c == '+' || c == '-' || c == '=' || c == '(' || c == ')' || c == '{' || c == '}' || c == ',' || c == ';' || c == '"' || c == '/' || isspace(c) || c == '\0';
+    return (classOf(c) & DELIMITER) != 0;
 }
 
 Token Lexer::getNextToken() {
-    while (isspace(currentChar)) {
+    Token token;
+    readToken(token);
+    return token;
+}
+
+void Lexer::readToken(Token& out) {
+    AllocCategoryScope allocCategory(AllocCategory::TOKENS);
+    while (classOf(currentChar) & SPACE) {
         if (currentChar == '\n') {
             currentLine++;
             currentPos = 0;
@@ -105,37 +217,47 @@ Token Lexer::getNextToken() {
         nextChar();
     }
     if (currentChar == '\0') {
-        return Token(TokenType::END_OF_FILE, "", currentLine, currentPos);
+        out.type = TokenType::END_OF_FILE;
+        out.value.clear();
+        out.line = currentLine;
+        out.position = currentPos;
+        out.offset = tokenOffset();
+        return;
     }
-    int line = currentLine;
-    int pos = currentPos;
-    if (isalpha(currentChar)) {
-        return parseIdentifier();
+    if (classOf(currentChar) & ALPHA) {
+        parseIdentifier(out);
+        return;
     }
-    if (isdigit(currentChar)) {
-        return parseNumber();
+    if (classOf(currentChar) & DIGIT) {
+        parseNumber(out);
+        return;
     }
     if (currentChar == '"') {
-        return parseString();
+        parseString(out);
+        return;
     }
+    out.line = currentLine;
+    out.position = currentPos;
+    out.offset = tokenOffset();
     char ch = currentChar;
     nextChar();
+    out.value.assign(1, ch);
     switch (ch) {
-    case '+': return Token(TokenType::PLUS, "+", line, pos);
-    case '-': return Token(TokenType::MINUS, "-", line, pos);
-    case '=': return Token(TokenType::ASSIGN, "=", line, pos);
-    case '(': return Token(TokenType::LPAREN, "(", line, pos);
-    case ')': return Token(TokenType::RPAREN, ")", line, pos);
-    case '{': return Token(TokenType::LBRACE, "{", line, pos);
-    case '}': return Token(TokenType::RBRACE, "}", line, pos);
-    case ',': return Token(TokenType::COMMA, ",", line, pos);
-    case ';': return Token(TokenType::SEMICOLON, ";", line, pos);
+    case '+': out.type = TokenType::PLUS; return;
+    case '-': out.type = TokenType::MINUS; return;
+    case '=': out.type = TokenType::ASSIGN; return;
+    case '(': out.type = TokenType::LPAREN; return;
+    case ')': out.type = TokenType::RPAREN; return;
+    case '{': out.type = TokenType::LBRACE; return;
+    case '}': out.type = TokenType::RBRACE; return;
+    case ',': out.type = TokenType::COMMA; return;
+    case ';': out.type = TokenType::SEMICOLON; return;
     default:
-        std::string value(1, ch);
         while (currentChar != '\0' && !isValidSymbol(currentChar)) {
-            value += currentChar;
+            out.value += currentChar;
             nextChar();
         }
-        return Token(TokenType::ERROR, value, line, pos);
+        out.type = TokenType::ERROR;
+        return;
     }
-}
\ No newline at end of file
+}
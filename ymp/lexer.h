@@ -2,24 +2,35 @@
 #define LEXER_H
 
 #include "token.h"
-#include <fstream>
+#include <cstddef>
 #include <string>
 
 class Lexer {
 private:
-    std::ifstream inputFile;
+    std::string ownedSource;
+    const char* begin;
+    const char* cursor;
+    const char* end;
     int currentLine;
     int currentPos;
     char currentChar;
+    bool asciiOnly;
     void nextChar();
-    Token parseIdentifier();
-    Token parseNumber();
-    Token parseString();
+    void advanceTo(const char* stop);
+    int tokenOffset() const;
+    void parseIdentifier(Token& out);
+    void parseNumber(Token& out);
+    void parseIntValue(Token& out);
+    void parseString(Token& out);
     bool isValidSymbol(char c);
 public:
     Lexer(const std::string& inputFilename);
-    ~Lexer();
+    Lexer(const char* data, size_t size);
+    Lexer(const Lexer&) = delete;
+    Lexer& operator=(const Lexer&) = delete;
+    void setAsciiOnly(bool ascii);
     Token getNextToken();
+    void readToken(Token& out);
 };
 
 #endif
\ No newline at end of file
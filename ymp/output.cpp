@@ -0,0 +1,138 @@
+#include "output.h"
+#include <cerrno>
+#include <cstring>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+OutputSink::~OutputSink() {
+}
+
+StreamSink::StreamSink(std::ostream& s) : stream(s) {
+}
+
+void StreamSink::write(const char* data, size_t size) {
+    stream.write(data, static_cast<std::streamsize>(size));
+}
+
+StringSink::StringSink(std::string& t) : target(t) {
+}
+
+void StringSink::write(const char* data, size_t size) {
+    target.append(data, size);
+}
+
+FdSink::FdSink(int f) : fd(f) {
+}
+
+void FdSink::write(const char* data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        int written = _write(fd, data, static_cast<unsigned int>(size));
+#else
+        ssize_t written = ::write(fd, data, size);
+#endif
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+OutputBuffer::OutputBuffer(size_t capacity) : buffer(capacity), used(0), sink(nullptr) {
+}
+
+OutputBuffer::OutputBuffer(OutputSink& s, size_t capacity) : buffer(capacity), used(0), sink(&s) {
+}
+
+OutputBuffer::~OutputBuffer() {
+    flush();
+}
+
+void OutputBuffer::setSink(OutputSink* s) {
+    flush();
+    sink = s;
+}
+
+void OutputBuffer::reserveSpace(size_t size) {
+    if (used + size <= buffer.size()) {
+        return;
+    }
+    if (sink != nullptr) {
+        flush();
+        if (size <= buffer.size()) {
+            return;
+        }
+    }
+    size_t capacity = buffer.size() * 2;
+    while (capacity < used + size) {
+        capacity *= 2;
+    }
+    buffer.resize(capacity);
+}
+
+void OutputBuffer::put(char c) {
+    if (used == buffer.size()) {
+        reserveSpace(1);
+    }
+    buffer[used++] = c;
+}
+
+void OutputBuffer::append(const char* data, size_t size) {
+    if (sink != nullptr && size > buffer.size()) {
+        flush();
+        sink->write(data, size);
+        return;
+    }
+    reserveSpace(size);
+    std::memcpy(buffer.data() + used, data, size);
+    used += size;
+}
+
+void OutputBuffer::append(const char* text) {
+    append(text, std::strlen(text));
+}
+
+void OutputBuffer::append(const std::string& s) {
+    append(s.data(), s.size());
+}
+
+void OutputBuffer::appendInt(long long value) {
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+    do {
+        *--p = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        *--p = '-';
+    }
+    append(p, static_cast<size_t>(end - p));
+}
+
+void OutputBuffer::flush() {
+    if (sink != nullptr && used > 0) {
+        sink->write(buffer.data(), used);
+        used = 0;
+    }
+}
+
+void OutputBuffer::clear() {
+    used = 0;
+}
+
+size_t OutputBuffer::size() const {
+    return used;
+}
+
+const char* OutputBuffer::data() const {
+    return buffer.data();
+}
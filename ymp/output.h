@@ -0,0 +1,62 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class OutputSink {
+public:
+    virtual ~OutputSink();
+    virtual void write(const char* data, size_t size) = 0;
+};
+
+class StreamSink : public OutputSink {
+private:
+    std::ostream& stream;
+public:
+    StreamSink(std::ostream& s);
+    void write(const char* data, size_t size) override;
+};
+
+class StringSink : public OutputSink {
+private:
+    std::string& target;
+public:
+    StringSink(std::string& t);
+    void write(const char* data, size_t size) override;
+};
+
+class FdSink : public OutputSink {
+private:
+    int fd;
+public:
+    FdSink(int f);
+    void write(const char* data, size_t size) override;
+};
+
+class OutputBuffer {
+private:
+    static const size_t DEFAULT_CAPACITY = 64 * 1024;
+    std::vector<char> buffer;
+    size_t used;
+    OutputSink* sink;
+    void reserveSpace(size_t size);
+public:
+    OutputBuffer(size_t capacity = DEFAULT_CAPACITY);
+    OutputBuffer(OutputSink& s, size_t capacity = DEFAULT_CAPACITY);
+    ~OutputBuffer();
+    void setSink(OutputSink* s);
+    void put(char c);
+    void append(const char* data, size_t size);
+    void append(const char* text);
+    void append(const std::string& s);
+    void appendInt(long long value);
+    void flush();
+    void clear();
+    size_t size() const;
+    const char* data() const;
+};
+
+#endif
@@ -1,43 +1,140 @@
 #include "parser.h"
+#include "alloctrack.h"
+#include "attributes.h"
+#include "trace.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <utility>
 
 ParseTreeNode::ParseTreeNode(const std::string& n, const Token& t, int l) : name(n), token(t), line(l) {}
 
+int LexemeTable::intern(const std::string& text) {
+    auto inserted = ids.emplace(text, static_cast<int>(lexemes.size()));
+    if (inserted.second) {
+        lexemes.push_back(&inserted.first->first);
+    }
+    return inserted.first->second;
+}
+
+const std::string& LexemeTable::text(int id) const {
+    return *lexemes[id];
+}
+
+size_t LexemeTable::size() const {
+    return lexemes.size();
+}
+
+ExprCode::ExprCode(std::shared_ptr<const LexemeTable> table) : lexemes(std::move(table)) {
+}
+
+const std::string& ExprCode::text(const ExprOp& op) const {
+    return lexemes->text(op.operand);
+}
+
 void ParseTreeNode::addChild(std::shared_ptr<ParseTreeNode> child) {
     children.push_back(child);
 }
 
-Parser::Parser(Lexer& l) : lexer(l) {
+Parser::Parser(Lexer& l)
+    : tokens(l), lexemes(std::make_shared<LexemeTable>()), currentExpr(nullptr), exprNesting(0), exprTooDeep(false), maxErrors(DEFAULT_MAX_ERRORS), suppressCascades(true), recovering(false), aborted(false) {
     nextToken();
 }
 
+void Parser::setMaxErrors(size_t limit) {
+    maxErrors = limit;
+}
+
+void Parser::setSuppressCascades(bool suppress) {
+    suppressCascades = suppress;
+}
+
 void Parser::nextToken() {
-    currentToken = lexer.getNextToken();
+    if (aborted) {
+        currentToken = Token(TokenType::END_OF_FILE, "", currentToken.line, currentToken.position);
+        return;
+    }
+    tokens.next(currentToken);
+}
+
+void Parser::resynchronized() {
+    recovering = false;
 }
 
 void Parser::error(const std::string& message) {
+    if (aborted || (suppressCascades && recovering)) {
+        return;
+    }
+    AllocCategoryScope allocCategory(AllocCategory::DIAGNOSTICS);
+    recovering = true;
     std::stringstream s;
     s << "Syntax error at line " << currentToken.line << ", position " << currentToken.position << ": " << message;
     errors.push_back(s.str());
+    if (maxErrors != 0 && errors.size() >= maxErrors) {
+        errors.push_back("too many errors, stopping");
+        aborted = true;
+        currentToken = Token(TokenType::END_OF_FILE, "", currentToken.line, currentToken.position);
+    }
+}
+
+YMP_COLD void Parser::expected(const char* message) {
+    error(message);
 }
 
+YMP_COLD void Parser::unexpected(TokenType expected) {
+    error("Expected " + Token(expected).getTypeString() + " but found '" + currentToken.excerpt() + "'");
+}
+
+YMP_COLD void Parser::missingOperand(ExprOpKind op) {
+    error(op == ExprOpKind::ADD ? "Missing operand after '+' operator" : "Missing operand after '-' operator");
+}
+
+YMP_COLD void Parser::invalidToken(const char* context) {
+    error("Invalid token '" + currentToken.excerpt() + "' in " + context);
+}
+
+YMP_COLD void Parser::outOfRange() {
+    error("Integer constant '" + currentToken.excerpt() + "' is out of range");
+}
+
+// Reported once per expression. The rest of the statement is skipped here,
+// without recursing, and the enclosing levels unwind without reporting the
+// ')' they no longer find.
+YMP_COLD void Parser::expressionTooDeep() {
+    if (exprTooDeep) {
+        return;
+    }
+    exprTooDeep = true;
+    error("Expression is nested more than " + std::to_string(MAX_EXPRESSION_DEPTH) + " levels deep");
+    while (currentToken.type != TokenType::SEMICOLON && currentToken.type != TokenType::END_OF_FILE && currentToken.type != TokenType::RETURN && currentToken.type != TokenType::RBRACE) {
+        nextToken();
+    }
+}
+
+// An identifier only restarts parsing when the next token is '=': one that
+// is part of the broken statement would otherwise be read as a new
+// assignment and report a second, cascading error.
 void Parser::synchronizeToStatementEnd() {
-    while (currentToken.type != TokenType::SEMICOLON && currentToken.type != TokenType::END_OF_FILE && currentToken.type != TokenType::RETURN && currentToken.type != TokenType::RBRACE && currentToken.type != TokenType::ID) {
+    while (currentToken.type != TokenType::SEMICOLON && currentToken.type != TokenType::END_OF_FILE && currentToken.type != TokenType::RETURN && currentToken.type != TokenType::RBRACE
+        && (currentToken.type != TokenType::ID || tokens.peek().type != TokenType::ASSIGN)) {
         nextToken();
     }
     if (currentToken.type == TokenType::SEMICOLON) {
         nextToken();
     }
+    resynchronized();
 }
 
 void Parser::match(TokenType expected) {
     if (currentToken.type == expected) {
+        if (expected == TokenType::SEMICOLON || expected == TokenType::LBRACE || expected == TokenType::RBRACE) {
+            resynchronized();
+        }
         nextToken();
     }
     else {
-        error("Expected " + Token(expected).getTypeString() + " but found '" + currentToken.value + "'");
+        unexpected(expected);
         if (expected == TokenType::SEMICOLON || expected == TokenType::RBRACE || expected == TokenType::RPAREN) {
             synchronizeToStatementEnd();
         }
@@ -69,7 +166,7 @@ std::shared_ptr<ParseTreeNode> Parser::parseEnd() {
         match(TokenType::RETURN);
     }
     else {
-        error("Expected RETURN but found '" + currentToken.value + "'");
+        error("Expected RETURN but found '" + currentToken.excerpt() + "'");
         return node;
     }
     if (currentToken.type == TokenType::ID) {
@@ -123,6 +220,7 @@ std::shared_ptr<ParseTreeNode> Parser::parseOperators() {
 }
 
 std::shared_ptr<ParseTreeNode> Parser::parseDescr() {
+    TraceScope scope("Descr", "statement", TraceLevel::STATEMENTS, "line", currentToken.line);
     auto node = std::make_shared<ParseTreeNode>("Descr", Token(), currentToken.line);
     node->addChild(parseType());
     node->addChild(parseVarList());
@@ -168,7 +266,7 @@ std::shared_ptr<ParseTreeNode> Parser::parseType() {
         match(TokenType::CHAR);
     }
     else if (currentToken.type == TokenType::ID) {
-        error("Unknown type '" + currentToken.value);
+        error("Unknown type '" + currentToken.excerpt());
         auto errorNode = std::make_shared<ParseTreeNode>("ERROR", currentToken, currentToken.line);
         node->addChild(errorNode);
         match(TokenType::ID);
@@ -181,6 +279,7 @@ std::shared_ptr<ParseTreeNode> Parser::parseType() {
 }
 
 std::shared_ptr<ParseTreeNode> Parser::parseOp() {
+    TraceScope scope("Op", "statement", TraceLevel::STATEMENTS, "line", currentToken.line);
     auto node = std::make_shared<ParseTreeNode>("Op", Token(), currentToken.line);
     if (currentToken.type == TokenType::ID) {
         auto idNode = std::make_shared<ParseTreeNode>("Id", currentToken, currentToken.line);
@@ -207,7 +306,7 @@ std::shared_ptr<ParseTreeNode> Parser::parseOp() {
         }
     }
     else {
-        error("Expected identifier at start of operator but found '" + currentToken.value + "'");
+        error("Expected identifier at start of operator but found '" + currentToken.excerpt() + "'");
         if (currentToken.type == TokenType::ASSIGN) {
             error("Missing identifier before '='");
             match(TokenType::ASSIGN);
@@ -232,94 +331,157 @@ std::shared_ptr<ParseTreeNode> Parser::parseOp() {
     return node;
 }
 
+// The expression node only carries its ExprCode; operands and operators go
+// straight into the postorder ops instead of into child nodes.
 std::shared_ptr<ParseTreeNode> Parser::parseNumExpr() {
-    auto node = std::make_shared<ParseTreeNode>("NumExpr", Token(), currentToken.line);
-    if (parseSimpleNumExpr(node)) {
-        while (currentToken.type == TokenType::PLUS || currentToken.type == TokenType::MINUS) {
-            auto opNode = std::make_shared<ParseTreeNode>(currentToken.type == TokenType::PLUS ? "Plus" : "Minus", currentToken, currentToken.line);
-            node->addChild(opNode);
-            if (currentToken.type == TokenType::PLUS) {
-                match(TokenType::PLUS);
-            }
-            else {
-                match(TokenType::MINUS);
-            }
+    std::shared_ptr<ParseTreeNode> node = makeExprNode("NumExpr");
+    beginExpr(*node);
+    parseNumSum();
+    currentExpr = nullptr;
+    return node;
+}
 
-            if (!parseSimpleNumExpr(node)) {
-                error("Missing operand after '" + opNode->token.value + "' operator");
-                break;
-            }
-        }
-    }
+YMP_NOINLINE std::shared_ptr<ParseTreeNode> Parser::makeExprNode(const char* name) {
+    auto node = std::make_shared<ParseTreeNode>(name, Token(), currentToken.line);
+    node->code = std::make_unique<ExprCode>(lexemes);
     return node;
 }
 
-bool Parser::parseSimpleNumExpr(std::shared_ptr<ParseTreeNode> parent) {
-    if (currentToken.type == TokenType::ID) {
-        auto idNode = std::make_shared<ParseTreeNode>("Id", currentToken, currentToken.line);
-        parent->addChild(idNode);
-        match(TokenType::ID);
-        return true;
+void Parser::beginExpr(ParseTreeNode& node) {
+    currentExpr = node.code.get();
+    exprHeights.clear();
+    exprNesting = 0;
+    exprTooDeep = false;
+}
+
+// exprHeights mirrors the operand stack of the postorder ops, so the height of
+// the operator tree is known as it is built. Later passes walk that tree
+// recursively, so it is held to the same limit as the nesting of parentheses.
+void Parser::addOperand(ExprOpKind kind) {
+    if (kind == ExprOpKind::CONST) {
+        currentExpr->ops.push_back(ExprOp{ kind, currentToken.line, -1, currentToken.intValue });
     }
-    else if (currentToken.type == TokenType::INT_NUM) {
-        auto constNode = std::make_shared<ParseTreeNode>("Const", currentToken, currentToken.line);
-        parent->addChild(constNode);
-        match(TokenType::INT_NUM);
-        return true;
+    else {
+        currentExpr->ops.push_back(ExprOp{ kind, currentToken.line, lexemes->intern(currentToken.value), 0 });
+    }
+    exprHeights.push_back(0);
+}
+
+void Parser::addOperator(ExprOpKind kind, int line) {
+    currentExpr->ops.push_back(ExprOp{ kind, line, -1, 0 });
+    if (kind != ExprOpKind::ADD && kind != ExprOpKind::SUB) {
+        exprHeights.push_back(0);
+        return;
+    }
+    if (exprHeights.size() < 2) {
+        return;
     }
-    else if (currentToken.type == TokenType::LPAREN) {
+    int right = exprHeights.back();
+    exprHeights.pop_back();
+    int height = std::max(exprHeights.back(), right) + 1;
+    exprHeights.back() = height;
+    if (height > MAX_EXPRESSION_DEPTH) {
+        expressionTooDeep();
+    }
+}
+
+// parseNumSum and parseSimpleNumExpr recurse once per '(' level, so only
+// the recursion itself stays in them; the operator loop, operands and
+// diagnostics live in helpers whose frames are gone before the next level.
+void Parser::parseNumSum() {
+    if (parseSimpleNumExpr()) {
+        parseNumExprTail();
+    }
+}
+
+YMP_NOINLINE void Parser::parseNumExprTail() {
+    while (currentToken.type == TokenType::PLUS || currentToken.type == TokenType::MINUS) {
+        ExprOpKind opKind = currentToken.type == TokenType::PLUS ? ExprOpKind::ADD : ExprOpKind::SUB;
+        int line = currentToken.line;
+        nextToken();
+        if (!parseSimpleNumExpr()) {
+            missingOperand(opKind);
+            break;
+        }
+        addOperator(opKind, line);
+    }
+}
+
+bool Parser::parseSimpleNumExpr() {
+    if (currentToken.type == TokenType::LPAREN) {
+        if (exprNesting == MAX_EXPRESSION_DEPTH) {
+            addOperator(ExprOpKind::INVALID, currentToken.line);
+            expressionTooDeep();
+            return true;
+        }
         match(TokenType::LPAREN);
-        parent->addChild(parseNumExpr());
+        exprNesting++;
+        parseNumSum();
+        exprNesting--;
         if (currentToken.type == TokenType::RPAREN) {
             match(TokenType::RPAREN);
         }
-        else {
-            error("Expected ')' after expression");
+        else if (!exprTooDeep) {
+            expected("Expected ')' after expression");
         }
         return true;
     }
+    return parseNumOperand();
+}
+
+YMP_NOINLINE bool Parser::parseNumOperand() {
+    if (currentToken.type == TokenType::ID) {
+        addOperand(ExprOpKind::ID);
+        match(TokenType::ID);
+        return true;
+    }
+    else if (currentToken.type == TokenType::INT_NUM) {
+        addOperand(ExprOpKind::CONST);
+        if (currentToken.outOfRange) {
+            outOfRange();
+        }
+        match(TokenType::INT_NUM);
+        return true;
+    }
     else if (currentToken.type == TokenType::ERROR) {
-        auto errorNode = std::make_shared<ParseTreeNode>("ERROR", currentToken, currentToken.line);
-        parent->addChild(errorNode);
-        error("Invalid token '" + currentToken.value + "' in numeric expression");
+        addOperator(ExprOpKind::INVALID, currentToken.line);
+        invalidToken("numeric expression");
         match(TokenType::ERROR);
         return false;
     }
     else {
-        error("Expected identifier, constant or '(' in numeric expression");
+        expected("Expected identifier, constant or '(' in numeric expression");
         return false;
     }
 }
 
 std::shared_ptr<ParseTreeNode> Parser::parseStringExpr() {
-    auto node = std::make_shared<ParseTreeNode>("StringExpr", Token(), currentToken.line);
-    node->addChild(parseSimpleStringExpr());
+    std::shared_ptr<ParseTreeNode> node = makeExprNode("StringExpr");
+    beginExpr(*node);
+    parseSimpleStringExpr();
     while (currentToken.type == TokenType::PLUS) {
-        auto plusNode = std::make_shared<ParseTreeNode>("Plus", currentToken, currentToken.line);
-        node->addChild(plusNode);
+        int line = currentToken.line;
         match(TokenType::PLUS);
-        node->addChild(parseSimpleStringExpr());
+        parseSimpleStringExpr();
+        addOperator(ExprOpKind::ADD, line);
     }
+    currentExpr = nullptr;
     return node;
 }
 
-std::shared_ptr<ParseTreeNode> Parser::parseSimpleStringExpr() {
-    auto node = std::make_shared<ParseTreeNode>("SimpleStringExpr", Token(), currentToken.line);
+void Parser::parseSimpleStringExpr() {
     if (currentToken.type == TokenType::CHAR_CONST) {
-        auto stringNode = std::make_shared<ParseTreeNode>("char_const", currentToken, currentToken.line);
-        node->addChild(stringNode);
+        addOperand(ExprOpKind::STRING);
         match(TokenType::CHAR_CONST);
     }
     else if (currentToken.type == TokenType::ERROR) {
-        auto errorNode = std::make_shared<ParseTreeNode>("ERROR", currentToken, currentToken.line);
-        node->addChild(errorNode);
-        error("Invalid token '" + currentToken.value + "' in string expression");
+        addOperator(ExprOpKind::INVALID, currentToken.line);
+        invalidToken("string expression");
         match(TokenType::ERROR);
     }
     else {
-        error("Expected string constant");
+        expected("Expected string constant");
     }
-    return node;
 }
 bool Parser::hasErrors() const {
     return !errors.empty();
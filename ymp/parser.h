@@ -3,29 +3,94 @@
 
 #include "lexer.h"
 #include "token.h"
+#include "tokenstream.h"
 #include <vector>
 #include <string>
 #include <memory>
+#include <unordered_map>
+
+enum class ExprOpKind : unsigned char {
+    ID,
+    CONST,
+    STRING,
+    ADD,
+    SUB,
+    INVALID
+};
+
+// The distinct identifier and string literal spellings of one parse. Map
+// nodes do not move, so the pointers in lexemes stay valid as it grows.
+class LexemeTable {
+private:
+    std::unordered_map<std::string, int> ids;
+    std::vector<const std::string*> lexemes;
+public:
+    int intern(const std::string& text);
+    const std::string& text(int id) const;
+    size_t size() const;
+};
+
+// operand is a LexemeTable id for ID and STRING and -1 otherwise; a CONST
+// carries its value and has no spelling of its own.
+struct ExprOp {
+    ExprOpKind kind;
+    int line;
+    int operand;
+    int value;
+};
+
+struct ExprCode {
+    std::vector<ExprOp> ops;
+    std::shared_ptr<const LexemeTable> lexemes;
+    explicit ExprCode(std::shared_ptr<const LexemeTable> table);
+    const std::string& text(const ExprOp& op) const;
+};
 
 struct ParseTreeNode {
     std::string name;
     Token token;
     std::vector<std::shared_ptr<ParseTreeNode>> children;
     int line;
+    std::unique_ptr<ExprCode> code;
     ParseTreeNode(const std::string& n, const Token& t = Token(), int l = 0);
     void addChild(std::shared_ptr<ParseTreeNode> child);
 };
 
 class Parser {
 private:
-    Lexer& lexer;
+    static const size_t DEFAULT_MAX_ERRORS = 100;
+    static const int MAX_EXPRESSION_DEPTH = 10000;
+    TokenStream tokens;
     Token currentToken;
+    std::shared_ptr<LexemeTable> lexemes;
+    ExprCode* currentExpr;
+    std::vector<int> exprHeights;
+    int exprNesting;
+    bool exprTooDeep;
     std::vector<std::string> errors;
+    size_t maxErrors;
+    bool suppressCascades;
+    bool recovering;
+    bool aborted;
     void nextToken();
+    void resynchronized();
     void error(const std::string& message);
+    void expected(const char* message);
+    void unexpected(TokenType expected);
+    void missingOperand(ExprOpKind op);
+    void invalidToken(const char* context);
+    void outOfRange();
+    void expressionTooDeep();
     void match(TokenType expected);
     void synchronizeToStatementEnd();
-    bool parseSimpleNumExpr(std::shared_ptr<ParseTreeNode> parent);
+    std::shared_ptr<ParseTreeNode> makeExprNode(const char* name);
+    void beginExpr(ParseTreeNode& node);
+    void addOperand(ExprOpKind kind);
+    void addOperator(ExprOpKind kind, int line);
+    void parseNumSum();
+    void parseNumExprTail();
+    bool parseSimpleNumExpr();
+    bool parseNumOperand();
     std::shared_ptr<ParseTreeNode> parseBegin();
     std::shared_ptr<ParseTreeNode> parseEnd();
     std::shared_ptr<ParseTreeNode> parseFunctionName();
@@ -37,9 +102,11 @@ private:
     std::shared_ptr<ParseTreeNode> parseOp();
     std::shared_ptr<ParseTreeNode> parseNumExpr();
     std::shared_ptr<ParseTreeNode> parseStringExpr();
-    std::shared_ptr<ParseTreeNode> parseSimpleStringExpr();
+    void parseSimpleStringExpr();
 public:
     Parser(Lexer& l);
+    void setMaxErrors(size_t limit);
+    void setSuppressCascades(bool suppress);
     std::shared_ptr<ParseTreeNode> parseFunction();
     bool hasErrors() const;
     const std::vector<std::string>& getErrors() const;
@@ -0,0 +1,166 @@
+#include "postfix.h"
+
+PostfixEmitter::PostfixEmitter(OutputBuffer& o) : out(o) {
+}
+
+void PostfixEmitter::emit(const std::shared_ptr<ParseTreeNode>& root) {
+    if (!root || root->name != "Function") return;
+    out.append("\n=== POSTFIX NOTATION ===\n");
+    for (const auto& child : root->children) {
+        if (child->name == "Descriptions") {
+            for (const auto& descr : child->children) {
+                if (descr->name == "Descr") {
+                    emitDescr(*descr);
+                }
+            }
+        }
+        else if (child->name == "Operators") {
+            for (const auto& op : child->children) {
+                if (op->name == "Op") {
+                    emitOp(*op);
+                }
+            }
+        }
+        else if (child->name == "End") {
+            emitEnd(*child);
+        }
+    }
+    out.flush();
+}
+
+void PostfixEmitter::emitDescr(const ParseTreeNode& descrNode) {
+    if (descrNode.children.size() < 2) return;
+    const ParseTreeNode& typeNode = *descrNode.children[0];
+    const ParseTreeNode& varListNode = *descrNode.children[1];
+    int varCount = 0;
+    for (const auto& var : varListNode.children) {
+        if (var->name == "Id") varCount++;
+    }
+    if (varCount == 0) return;
+    bool isChar = typeNode.name == "Type" && !typeNode.children.empty() && typeNode.children[0]->token.value == "char";
+    if (isChar) {
+        out.append("char");
+    }
+    else {
+        out.append("int");
+    }
+    for (const auto& var : varListNode.children) {
+        if (var->name == "Id") {
+            out.put(' ');
+            out.append(var->token.value);
+        }
+    }
+    out.put(' ');
+    out.appendInt(varCount + 1);
+    out.append(" decl\n");
+}
+
+void PostfixEmitter::emitOp(const ParseTreeNode& opNode) {
+    if (opNode.children.size() < 2) return;
+    if (opNode.children[1]->code) {
+        emitExpr(*opNode.children[1]->code);
+    }
+    if (opNode.children[0]->name == "Id") {
+        out.append(opNode.children[0]->token.value);
+        out.append(" =\n");
+    }
+}
+
+void PostfixEmitter::emitEnd(const ParseTreeNode& endNode) {
+    if (!endNode.children.empty() && endNode.children[0]->name == "Id") {
+        out.append(endNode.children[0]->token.value);
+        out.append(" RETURN\n");
+    }
+}
+
+void PostfixEmitter::emitExpr(const ExprCode& code) {
+    for (const ExprOp& op : code.ops) {
+        switch (op.kind) {
+        case ExprOpKind::ID:
+            out.append(code.text(op));
+            out.put(' ');
+            break;
+        case ExprOpKind::STRING:
+            out.put('"');
+            out.append(code.text(op));
+            out.append("\" ");
+            break;
+        case ExprOpKind::CONST:
+            out.appendInt(op.value);
+            out.put(' ');
+            break;
+        case ExprOpKind::ADD:
+            out.append("+ ");
+            break;
+        case ExprOpKind::SUB:
+            out.append("- ");
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void PostfixEmitter::emit(const IrFunction& function) {
+    out.append("\n=== POSTFIX NOTATION ===\n");
+    for (const IrDeclGroup& group : function.decls) {
+        long long liveCount = 0;
+        for (int variable : group.variables) {
+            if (!function.variables[variable].dead) liveCount++;
+        }
+        if (liveCount == 0) continue;
+        out.append(group.type == IrType::CHAR_TYPE ? "char" : "int");
+        for (int variable : group.variables) {
+            if (function.variables[variable].dead) continue;
+            out.put(' ');
+            out.append(function.variables[variable].name);
+        }
+        out.put(' ');
+        out.appendInt(liveCount + 1);
+        out.append(" decl\n");
+    }
+    std::vector<int> tempDefs(function.tempCount, -1);
+    for (size_t i = 0; i < function.code.size(); i++) {
+        const IrInstr& instr = function.code[i];
+        if (instr.op == IrOp::ADD || instr.op == IrOp::SUB || instr.op == IrOp::CONCAT) {
+            tempDefs[instr.result] = static_cast<int>(i);
+        }
+        else if (instr.op == IrOp::DEF) {
+            emitOperand(function, instr.a, tempDefs);
+            out.append(function.variables[function.versions[instr.result].variable].name);
+            out.append(" =\n");
+        }
+        else if (instr.op == IrOp::RETURN) {
+            emitOperand(function, instr.a, tempDefs);
+            out.append("RETURN\n");
+        }
+    }
+    out.flush();
+}
+
+void PostfixEmitter::emitOperand(const IrFunction& function, const IrOperand& operand, const std::vector<int>& tempDefs) {
+    switch (operand.kind) {
+    case IrOperandKind::VERSION:
+        out.append(function.variables[function.variableOf(operand)].name);
+        out.put(' ');
+        break;
+    case IrOperandKind::INT_CONST:
+        out.append(function.literals[operand.index].text);
+        out.put(' ');
+        break;
+    case IrOperandKind::STR_CONST:
+        out.put('"');
+        out.append(function.literals[operand.index].text);
+        out.append("\" ");
+        break;
+    case IrOperandKind::TEMP: {
+        const IrInstr& instr = function.code[tempDefs[operand.index]];
+        emitOperand(function, instr.a, tempDefs);
+        emitOperand(function, instr.b, tempDefs);
+        out.append(instr.op == IrOp::SUB ? "- " : "+ ");
+        break;
+    }
+    default:
+        break;
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef POSTFIX_H
+#define POSTFIX_H
+
+#include "parser.h"
+#include "output.h"
+#include "ir.h"
+#include <memory>
+#include <vector>
+
+class PostfixEmitter {
+private:
+    OutputBuffer& out;
+    void emitDescr(const ParseTreeNode& descrNode);
+    void emitOp(const ParseTreeNode& opNode);
+    void emitEnd(const ParseTreeNode& endNode);
+    void emitExpr(const ExprCode& code);
+    void emitOperand(const IrFunction& function, const IrOperand& operand, const std::vector<int>& tempDefs);
+public:
+    PostfixEmitter(OutputBuffer& o);
+    void emit(const std::shared_ptr<ParseTreeNode>& root);
+    void emit(const IrFunction& function);
+};
+
+#endif
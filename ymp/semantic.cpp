@@ -1,56 +1,40 @@
 #include "semantic.h"
+#include "alloctrack.h"
+#include "postfix.h"
 #include <iostream>
 #include <sstream>
 
-SymbolInfo::SymbolInfo(const std::string& n, SymbolType t, int l, bool isFunc, SymbolType retType)
-    : name(n), type(t), line(l), isFunction(isFunc), returnType(retType) {
-}
-
 SemanticAnalyzer::SemanticAnalyzer()
-    : symbolTable(), currentFunctionReturnType(SymbolType::UNDEFINED), currentFunctionName("") {
-}
-int SemanticAnalyzer::findSymbolIndex(const std::string& name) const {
-    Token tempToken;
-    tempToken.value = name;
-    tempToken.type = TokenType::ID;
-    for (size_t i = 0; i < symbolInfoList.size(); ++i) {
-        if (symbolInfoList[i].name == name) {
-            return static_cast<int>(i);
-        }
-    }
-    return -1;
+    : maxErrors(DEFAULT_MAX_ERRORS), currentFunctionReturnType(SymbolType::UNDEFINED), currentFunctionName("") {
 }
 
+void SemanticAnalyzer::setMaxErrors(size_t limit) {
+    maxErrors = limit;
+}
 const SymbolInfo* SemanticAnalyzer::findSymbolInfo(const std::string& name) const {
-    for (const auto& info : symbolInfoList) {
-        if (info.name == name) {
-            return &info;
-        }
-    }
-    return nullptr;
+    return symbols.lookup(name);
 }
 
 SymbolInfo* SemanticAnalyzer::findSymbolInfo(const std::string& name) {
-    for (auto& info : symbolInfoList) {
-        if (info.name == name) {
-            return &info;
-        }
-    }
-    return nullptr;
+    return symbols.lookup(name);
 }
 
 void SemanticAnalyzer::addSymbolInfo(const SymbolInfo& info) {
-    symbolInfoList.push_back(info);
-    Token tempToken;
-    tempToken.value = info.name;
-    tempToken.type = TokenType::ID;
-    symbolTable.insert(tempToken);
+    AllocCategoryScope allocCategory(AllocCategory::SYMBOL_TABLE);
+    symbols.declare(info);
 }
 
 void SemanticAnalyzer::addError(const std::string& message, int line) {
+    if (maxErrors != 0 && errors.size() >= maxErrors) {
+        return;
+    }
+    AllocCategoryScope allocCategory(AllocCategory::DIAGNOSTICS);
     std::stringstream ss;
     ss << "Semantic error at line " << line << ": " << message;
     errors.push_back(ss.str());
+    if (maxErrors != 0 && errors.size() == maxErrors) {
+        errors.push_back("too many errors, stopping");
+    }
 }
 
 SymbolType SemanticAnalyzer::getTypeFromToken(TokenType tokenType) {
@@ -83,9 +67,11 @@ void SemanticAnalyzer::analyzeNode(std::shared_ptr<ParseTreeNode> node) {
 void SemanticAnalyzer::analyzeFunction(std::shared_ptr<ParseTreeNode> funcNode) {
     currentFunctionReturnType = SymbolType::UNDEFINED;
     currentFunctionName = "";
+    int outerDepth = symbols.depth();
     for (const auto& child : funcNode->children) {
         if (child->name == "Begin") {
             analyzeBegin(child);
+            symbols.enterScope();
         }
         else if (child->name == "Descriptions") {
             analyzeDescriptions(child);
@@ -97,6 +83,9 @@ void SemanticAnalyzer::analyzeFunction(std::shared_ptr<ParseTreeNode> funcNode)
             analyzeEnd(child);
         }
     }
+    while (symbols.depth() > outerDepth) {
+        symbols.exitScope();
+    }
 }
 
 void SemanticAnalyzer::analyzeBegin(std::shared_ptr<ParseTreeNode> beginNode) {
@@ -178,12 +167,15 @@ void SemanticAnalyzer::analyzeOp(std::shared_ptr<ParseTreeNode> opNode) {
                 return;
             }
             auto exprNode = opNode->children[1];
+            if (!exprNode->code) {
+                return;
+            }
             if (exprNode->name == "NumExpr") {
-                checkNumExprForAssignment(exprNode, *varInfo, line);
-                checkNumExpr(exprNode);
+                checkNumExprForAssignment(*exprNode->code, *varInfo, line);
+                checkNumExpr(*exprNode->code);
             }
             else if (exprNode->name == "StringExpr") {
-                checkStringExpr(exprNode);
+                checkStringExpr(*exprNode->code);
                 if (varInfo->type == SymbolType::INT_TYPE) {
                     addError("cannot assign char to int variable '" + varName + "'", line);
                 }
@@ -191,78 +183,48 @@ void SemanticAnalyzer::analyzeOp(std::shared_ptr<ParseTreeNode> opNode) {
         }
     }
 }
-void SemanticAnalyzer::checkNumExprForAssignment(std::shared_ptr<ParseTreeNode> node,
+void SemanticAnalyzer::checkNumExprForAssignment(const ExprCode& code,
     const SymbolInfo& targetVar,
     int assignmentLine) {
-    if (!node) return;
-    if (node->name == "Id") {
-        std::string exprVarName = node->token.value;
-        const SymbolInfo* exprVarInfo = findSymbolInfo(exprVarName);
-        if (exprVarInfo != nullptr) {
-            if (targetVar.type == SymbolType::INT_TYPE && exprVarInfo->type == SymbolType::CHAR_TYPE) {
-                addError("cannot assign char '" + exprVarName + "' to int '" + targetVar.name + "'",
-                    assignmentLine);
+    for (const ExprOp& op : code.ops) {
+        if (op.kind == ExprOpKind::ID) {
+            const std::string& exprVarName = code.text(op);
+            const SymbolInfo* exprVarInfo = findSymbolInfo(exprVarName);
+            if (exprVarInfo == nullptr) {
+                addError("Undeclared variable '" + exprVarName + "'", assignmentLine);
             }
-            else if (targetVar.type == SymbolType::CHAR_TYPE && exprVarInfo->type == SymbolType::INT_TYPE) {
-                addError("cannot assign int '" + exprVarName + "' to char '" + targetVar.name + "'",
-                    assignmentLine);
+            else if (exprVarInfo->isFunction) {
+                addError("Cannot use function '" + exprVarName + "' as a value", assignmentLine);
             }
-        }
-    }
-    else if (node->name == "Const" && targetVar.type == SymbolType::CHAR_TYPE) {
-        addError("cannot assign integer '" + node->token.value + "' to char '" + targetVar.name + "'",
-            assignmentLine);
-    }
-    for (const auto& child : node->children) {
-        checkNumExprForAssignment(child, targetVar, assignmentLine);
-    }
-}
-SymbolType SemanticAnalyzer::checkNumExpr(std::shared_ptr<ParseTreeNode> node) {
-    for (const auto& child : node->children) {
-        if (child->name == "SimpleNumExpr") {
-            if (checkSimpleNumExpr(child) == SymbolType::UNDEFINED) {
-                return SymbolType::UNDEFINED;
+            else {
+                if (targetVar.type == SymbolType::INT_TYPE && exprVarInfo->type == SymbolType::CHAR_TYPE) {
+                    addError("cannot assign char '" + exprVarName + "' to int '" + targetVar.name + "'",
+                        assignmentLine);
+                }
+                else if (targetVar.type == SymbolType::CHAR_TYPE && exprVarInfo->type == SymbolType::INT_TYPE) {
+                    addError("cannot assign int '" + exprVarName + "' to char '" + targetVar.name + "'",
+                        assignmentLine);
+                }
             }
         }
+        else if (op.kind == ExprOpKind::CONST && targetVar.type == SymbolType::CHAR_TYPE) {
+            addError("cannot assign integer '" + std::to_string(op.value) + "' to char '" + targetVar.name + "'",
+                assignmentLine);
+        }
     }
-    return SymbolType::INT_TYPE;
 }
-
-SymbolType SemanticAnalyzer::checkSimpleNumExpr(std::shared_ptr<ParseTreeNode> node) {
-    for (const auto& child : node->children) {
-        if (child->name == "Id") {
-            std::string varName = child->token.value;
-            const SymbolInfo* varInfo = findSymbolInfo(varName);
-            if (varInfo == nullptr) {
-                addError("Undeclared variable '" + varName + "'", child->token.line);
-                return SymbolType::UNDEFINED;
-            }
-            if (varInfo->type != SymbolType::INT_TYPE) {
-                addError("Variable '" + varName + "' must be integer type in numeric expression", child->token.line);
-                return SymbolType::UNDEFINED;
-            }
-            return SymbolType::INT_TYPE;
-        }
-        else if (child->name == "Const") {
-            return SymbolType::INT_TYPE;
-        }
-        else if (child->name == "NumExpr") {
-            return checkNumExpr(child);
+SymbolType SemanticAnalyzer::checkNumExpr(const ExprCode& code) {
+    for (const ExprOp& op : code.ops) {
+        if (op.kind == ExprOpKind::INVALID) {
+            return SymbolType::UNDEFINED;
         }
     }
-    return SymbolType::UNDEFINED;
+    return SymbolType::INT_TYPE;
 }
 
-SymbolType SemanticAnalyzer::checkStringExpr(std::shared_ptr<ParseTreeNode> node) {
-    for (const auto& child : node->children) {
-        if (child->name == "SimpleStringExpr") {
-            for (const auto& subChild : child->children) {
-                if (subChild->name == "char_const") {
-                    return SymbolType::CHAR_TYPE;
-                }
-            }
-        }
-        else if (child->name == "Plus") {
+SymbolType SemanticAnalyzer::checkStringExpr(const ExprCode& code) {
+    for (const ExprOp& op : code.ops) {
+        if (op.kind == ExprOpKind::STRING || op.kind == ExprOpKind::ADD) {
             return SymbolType::CHAR_TYPE;
         }
     }
@@ -293,6 +255,13 @@ void SemanticAnalyzer::analyzeEnd(std::shared_ptr<ParseTreeNode> endNode) {
     }
 }
 
+void SemanticAnalyzer::clear() {
+    symbols.clear();
+    errors.clear();
+    currentFunctionReturnType = SymbolType::UNDEFINED;
+    currentFunctionName.clear();
+}
+
 bool SemanticAnalyzer::hasErrors() const {
     return !errors.empty();
 }
@@ -301,106 +270,13 @@ const std::vector<std::string>& SemanticAnalyzer::getErrors() const {
     return errors;
 }
 
-void SemanticAnalyzer::generatePostfixForNode(std::shared_ptr<ParseTreeNode> node, std::ofstream& outFile) {
-    if (!node) return;
-    if (node->name == "Id") {
-        outFile << node->token.value << " ";
-    }
-    else if (node->name == "Const") {
-        outFile << node->token.value << " ";
-    }
-    else if (node->name == "char_const") {
-        std::string value = node->token.value;
-        if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
-            outFile << "\"" << value.substr(1, value.size() - 2) << "\" ";
-        }
-        else {
-            outFile << value << " ";
-        }
-    }
-    else if (node->name == "Plus" || node->name == "Minus") {
-        outFile << node->token.value << " ";
-    }
-    else if (node->name == "NumExpr") {
-        if (node->children.size() == 3) {
-            generatePostfixForNode(node->children[0], outFile);
-            generatePostfixForNode(node->children[2], outFile);
-            generatePostfixForNode(node->children[1], outFile);
-        }
-        else {
-            for (const auto& child : node->children) {
-                generatePostfixForNode(child, outFile);
-            }
-        }
-    }
-    else if (node->name == "StringExpr") {
-        if (node->children.size() == 3) {
-            generatePostfixForNode(node->children[0], outFile);
-            generatePostfixForNode(node->children[2], outFile);
-            outFile << "+ ";
-        }
-        else {
-            for (const auto& child : node->children) {
-                generatePostfixForNode(child, outFile);
-            }
-        }
-    }
-    else {
-        for (const auto& child : node->children) {
-            generatePostfixForNode(child, outFile);
-        }
-    }
+void SemanticAnalyzer::generatePostfix(std::shared_ptr<ParseTreeNode> node, std::ostream& outFile) {
+    StreamSink sink(outFile);
+    OutputBuffer buffer(sink);
+    generatePostfix(node, buffer);
 }
 
-void SemanticAnalyzer::generatePostfix(std::shared_ptr<ParseTreeNode> node, std::ofstream& outFile) {
-    if (!node) return;
-    if (node->name == "Function") {
-        outFile << "\n=== POSTFIX NOTATION ===" << std::endl;
-        for (const auto& child : node->children) {
-            if (child->name == "Descriptions") {
-                for (const auto& descr : child->children) {
-                    if (descr->name == "Descr" && descr->children.size() >= 2) {
-                        auto typeNode = descr->children[0];
-                        auto varListNode = descr->children[1];
-                        std::string typeStr = "int";
-                        if (typeNode->name == "Type" && !typeNode->children.empty()) {
-                            auto typeToken = typeNode->children[0]->token.value;
-                            typeStr = (typeToken == "char") ? "char" : "int";
-                        }
-                        int varCount = 0;
-                        std::stringstream varsStream;
-                        for (const auto& var : varListNode->children) {
-                            if (var->name == "Id") {
-                                if (varCount > 0) varsStream << " ";
-                                varsStream << var->token.value;
-                                varCount++;
-                            }
-                        }
-                        if (varCount > 0) {
-                            outFile << typeStr << " " << varsStream.str() << " " << varCount + 1 << " decl" << std::endl;
-                        }
-                    }
-                }
-            }
-        }
-        for (const auto& child : node->children) {
-            if (child->name == "Operators") {
-                for (const auto& op : child->children) {
-                    if (op->name == "Op" && op->children.size() >= 2) {
-                        generatePostfixForNode(op->children[1], outFile);
-                        if (op->children[0]->name == "Id") {
-                            outFile << op->children[0]->token.value << " =" << std::endl;
-                        }
-                    }
-                }
-            }
-        }
-        for (const auto& child : node->children) {
-            if (child->name == "End") {
-                if (!child->children.empty() && child->children[0]->name == "Id") {
-                    outFile << child->children[0]->token.value << " RETURN" << std::endl;
-                }
-            }
-        }
-    }
-}
\ No newline at end of file
+void SemanticAnalyzer::generatePostfix(std::shared_ptr<ParseTreeNode> node, OutputBuffer& out) {
+    PostfixEmitter emitter(out);
+    emitter.emit(node);
+}
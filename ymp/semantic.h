@@ -2,32 +2,18 @@
 #define SEMANTIC_H
 
 #include "parser.h"
-#include "hashtable.h"  
+#include "output.h"
+#include "symtab.h"
 #include <string>
 #include <vector>
-#include <fstream>
-
-enum class SymbolType {
-    INT_TYPE,
-    CHAR_TYPE,
-    FUNCTION_TYPE,
-    UNDEFINED
-};
-
-struct SymbolInfo {
-    std::string name;
-    SymbolType type;
-    int line;
-    bool isFunction;
-    SymbolType returnType;
-    SymbolInfo(const std::string& n = "", SymbolType t = SymbolType::UNDEFINED, int l = 0, bool isFunc = false, SymbolType retType = SymbolType::UNDEFINED);
-};
+#include <ostream>
 
 class SemanticAnalyzer {
 private:
-    HashTable symbolTable; 
-    std::vector<SymbolInfo> symbolInfoList;  
+    ScopedSymbolTable symbols;
+    static const size_t DEFAULT_MAX_ERRORS = 100;
     std::vector<std::string> errors;
+    size_t maxErrors;
     SymbolType currentFunctionReturnType;
     std::string currentFunctionName;
     void addError(const std::string& message, int line);
@@ -40,24 +26,23 @@ private:
     void analyzeVarList(std::shared_ptr<ParseTreeNode> varListNode, SymbolType type);
     void analyzeOperators(std::shared_ptr<ParseTreeNode> operatorsNode);
     void analyzeOp(std::shared_ptr<ParseTreeNode> opNode);
-    void checkNumExprForAssignment(std::shared_ptr<ParseTreeNode> opNode, const SymbolInfo& targetVar, int assignmentLine);
+    void checkNumExprForAssignment(const ExprCode& code, const SymbolInfo& targetVar, int assignmentLine);
     void analyzeEnd(std::shared_ptr<ParseTreeNode> endNode);
-    SymbolType checkNumExpr(std::shared_ptr<ParseTreeNode> node);
-    SymbolType checkStringExpr(std::shared_ptr<ParseTreeNode> node);
-    SymbolType checkSimpleNumExpr(std::shared_ptr<ParseTreeNode> node);
-    int findSymbolIndex(const std::string& name) const;
+    SymbolType checkNumExpr(const ExprCode& code);
+    SymbolType checkStringExpr(const ExprCode& code);
     const SymbolInfo* findSymbolInfo(const std::string& name) const;
     SymbolInfo* findSymbolInfo(const std::string& name);
     void addSymbolInfo(const SymbolInfo& info);
 
-    void generatePostfixForNode(std::shared_ptr<ParseTreeNode> node, std::ofstream& outFile);
-
 public:
     SemanticAnalyzer();
+    void setMaxErrors(size_t limit);
     void analyze(std::shared_ptr<ParseTreeNode> root);
+    void clear();
     bool hasErrors() const;
     const std::vector<std::string>& getErrors() const;
-    void generatePostfix(std::shared_ptr<ParseTreeNode> node, std::ofstream& outFile);
+    void generatePostfix(std::shared_ptr<ParseTreeNode> node, std::ostream& outFile);
+    void generatePostfix(std::shared_ptr<ParseTreeNode> node, OutputBuffer& out);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "sourcecheck.h"
+#include <cstdint>
+#include <cstring>
+
+// YMP_NO_SSE2 forces the portable word-at-a-time scan, so it can be tested on
+// machines that would otherwise always take the SSE2 path.
+#if !defined(YMP_NO_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define YMP_HAVE_SSE2 1
+#endif
+
+EncodingCheck::EncodingCheck() : ascii(true) {
+}
+
+bool EncodingCheck::valid() const {
+    return invalidOffsets.empty();
+}
+
+bool looksLikeText(const char* data, size_t size) {
+    if (size > SOURCE_PROBE_SIZE) {
+        size = SOURCE_PROBE_SIZE;
+    }
+    size_t controlCount = 0;
+    for (size_t i = 0; i < size; i++) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c == 0) {
+            return false;
+        }
+        if (c < 0x20 && c != '\t' && c != '\n' && c != '\r' && c != '\f' && c != '\v') {
+            controlCount++;
+        }
+    }
+    return controlCount * 10 <= size;
+}
+
+static size_t skipAscii(const unsigned char* data, size_t i, size_t size) {
+#ifdef YMP_HAVE_SSE2
+    while (i + 16 <= size) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int mask = _mm_movemask_epi8(chunk);
+        if (mask != 0) {
+            while ((mask & 1) == 0) {
+                mask >>= 1;
+                i++;
+            }
+            return i;
+        }
+        i += 16;
+    }
+#else
+    while (i + 8 <= size) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        if ((word & 0x8080808080808080ull) != 0) {
+            break;
+        }
+        i += 8;
+    }
+#endif
+    while (i < size && data[i] < 0x80) {
+        i++;
+    }
+    return i;
+}
+
+static size_t sequenceLength(const unsigned char* data, size_t i, size_t size) {
+    unsigned char lead = data[i];
+    size_t length;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) {
+            low = 0xA0;
+        }
+        else if (lead == 0xED) {
+            high = 0x9F;
+        }
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) {
+            low = 0x90;
+        }
+        else if (lead == 0xF4) {
+            high = 0x8F;
+        }
+    }
+    else {
+        return 0;
+    }
+    if (i + length > size || data[i + 1] < low || data[i + 1] > high) {
+        return 0;
+    }
+    for (size_t k = 2; k < length; k++) {
+        if ((data[i + k] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+EncodingCheck checkEncoding(const char* data, size_t size) {
+    EncodingCheck check;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    size_t i = skipAscii(bytes, 0, size);
+    while (i < size) {
+        check.ascii = false;
+        size_t length = sequenceLength(bytes, i, size);
+        if (length == 0) {
+            if (check.invalidOffsets.size() == MAX_ENCODING_ERRORS) {
+                break;
+            }
+            check.invalidOffsets.push_back(i);
+            length = 1;
+            while (i + length < size && (bytes[i + length] & 0xC0) == 0x80) {
+                length++;
+            }
+        }
+        i = skipAscii(bytes, i + length, size);
+    }
+    return check;
+}
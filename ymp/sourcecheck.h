@@ -0,0 +1,20 @@
+#ifndef SOURCECHECK_H
+#define SOURCECHECK_H
+
+#include <cstddef>
+#include <vector>
+
+const size_t SOURCE_PROBE_SIZE = 64 * 1024;
+const size_t MAX_ENCODING_ERRORS = 16;
+
+struct EncodingCheck {
+    bool ascii;
+    std::vector<size_t> invalidOffsets;
+    EncodingCheck();
+    bool valid() const;
+};
+
+bool looksLikeText(const char* data, size_t size);
+EncodingCheck checkEncoding(const char* data, size_t size);
+
+#endif
@@ -0,0 +1,105 @@
+#include "symtab.h"
+
+SymbolInfo::SymbolInfo(const std::string& n, SymbolType t, int l, bool isFunc, SymbolType retType)
+    : name(n), type(t), line(l), isFunction(isFunc), returnType(retType) {
+}
+
+ScopedSymbolTable::ScopedSymbolTable() : slots(INITIAL_SIZE), slotCount(0) {
+}
+
+size_t ScopedSymbolTable::hash(const std::string& name) const {
+    size_t h = 2166136261u;
+    for (char c : name) {
+        h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return h;
+}
+
+size_t ScopedSymbolTable::findSlot(const std::string& name) const {
+    size_t mask = slots.size() - 1;
+    size_t i = hash(name) & mask;
+    while (slots[i].used && slots[i].name != name) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void ScopedSymbolTable::grow() {
+    std::vector<NameSlot> old;
+    old.swap(slots);
+    slots.resize(old.size() * 2);
+    for (NameSlot& entry : old) {
+        if (!entry.used) continue;
+        size_t i = findSlot(entry.name);
+        for (int b = entry.binding; b >= 0; b = bindings[b].shadowed) {
+            bindings[b].slot = i;
+        }
+        slots[i] = std::move(entry);
+    }
+}
+
+void ScopedSymbolTable::enterScope() {
+    scopeStarts.push_back(bindings.size());
+}
+
+void ScopedSymbolTable::exitScope() {
+    if (scopeStarts.empty()) return;
+    size_t start = scopeStarts.back();
+    scopeStarts.pop_back();
+    while (bindings.size() > start) {
+        const Binding& binding = bindings.back();
+        slots[binding.slot].binding = binding.shadowed;
+        bindings.pop_back();
+    }
+}
+
+int ScopedSymbolTable::depth() const {
+    return static_cast<int>(scopeStarts.size());
+}
+
+SymbolInfo* ScopedSymbolTable::lookup(const std::string& name) {
+    const NameSlot& entry = slots[findSlot(name)];
+    if (!entry.used || entry.binding < 0) {
+        return nullptr;
+    }
+    return &bindings[entry.binding].info;
+}
+
+const SymbolInfo* ScopedSymbolTable::lookup(const std::string& name) const {
+    const NameSlot& entry = slots[findSlot(name)];
+    if (!entry.used || entry.binding < 0) {
+        return nullptr;
+    }
+    return &bindings[entry.binding].info;
+}
+
+SymbolInfo* ScopedSymbolTable::lookupInCurrentScope(const std::string& name) {
+    const NameSlot& entry = slots[findSlot(name)];
+    if (!entry.used || entry.binding < 0 || bindings[entry.binding].scope != depth()) {
+        return nullptr;
+    }
+    return &bindings[entry.binding].info;
+}
+
+SymbolInfo& ScopedSymbolTable::declare(const SymbolInfo& info) {
+    if ((slotCount + 1) * 2 > slots.size()) {
+        grow();
+    }
+    size_t i = findSlot(info.name);
+    if (!slots[i].used) {
+        slots[i].name = info.name;
+        slots[i].binding = -1;
+        slots[i].used = true;
+        slotCount++;
+    }
+    bindings.push_back(Binding{ info, depth(), slots[i].binding, i });
+    slots[i].binding = static_cast<int>(bindings.size()) - 1;
+    return bindings.back().info;
+}
+
+void ScopedSymbolTable::clear() {
+    slots.assign(INITIAL_SIZE, NameSlot());
+    slotCount = 0;
+    bindings.clear();
+    scopeStarts.clear();
+}
@@ -0,0 +1,59 @@
+#ifndef SYMTAB_H
+#define SYMTAB_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class SymbolType {
+    INT_TYPE,
+    CHAR_TYPE,
+    FUNCTION_TYPE,
+    UNDEFINED
+};
+
+struct SymbolInfo {
+    std::string name;
+    SymbolType type;
+    int line;
+    bool isFunction;
+    SymbolType returnType;
+    SymbolInfo(const std::string& n = "", SymbolType t = SymbolType::UNDEFINED, int l = 0, bool isFunc = false, SymbolType retType = SymbolType::UNDEFINED);
+};
+
+class ScopedSymbolTable {
+private:
+    static const size_t INITIAL_SIZE = 64;
+    struct Binding {
+        SymbolInfo info;
+        int scope;
+        int shadowed;
+        size_t slot;
+    };
+    struct NameSlot {
+        std::string name;
+        int binding;
+        bool used;
+    };
+    std::vector<NameSlot> slots;
+    size_t slotCount;
+    std::vector<Binding> bindings;
+    std::vector<size_t> scopeStarts;
+    size_t hash(const std::string& name) const;
+    size_t findSlot(const std::string& name) const;
+    void grow();
+public:
+    ScopedSymbolTable();
+    void enterScope();
+    void exitScope();
+    int depth() const;
+    // The returned pointers and references point into the binding stack, so
+    // they are only valid until the next declare(), exitScope() or clear().
+    SymbolInfo* lookup(const std::string& name);
+    const SymbolInfo* lookup(const std::string& name) const;
+    SymbolInfo* lookupInCurrentScope(const std::string& name);
+    SymbolInfo& declare(const SymbolInfo& info);
+    void clear();
+};
+
+#endif
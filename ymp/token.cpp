@@ -1,7 +1,18 @@
 #include "token.h"
 
 Token::Token(TokenType t, const std::string& v, int l, int p)
-    : type(t), value(v), line(l), position(p) {
+    : type(t), value(v), line(l), position(p), offset(0), intValue(0), outOfRange(false) {
+}
+
+// A CHAR_CONST holds only the characters between the quotes; messages quote
+// it again so they show the literal as written.
+std::string Token::excerpt() const {
+    const size_t maxLength = 64;
+    std::string text = type == TokenType::CHAR_CONST ? '"' + value + '"' : value;
+    if (text.size() <= maxLength) {
+        return text;
+    }
+    return text.substr(0, maxLength) + "...";
 }
 
 std::string Token::getTypeString() const {
@@ -18,8 +18,12 @@ public:
     std::string value;
     int line;
     int position;
+    int offset;
+    int intValue;
+    bool outOfRange;
     Token(TokenType t = TokenType::END_OF_FILE, const std::string& v = "", int l = 0, int p = 0);
     std::string getTypeString() const;
+    std::string excerpt() const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,282 @@
+#include "tokenindex.h"
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char TOKEN_INDEX_MAGIC[8] = { 'Y', 'M', 'P', 'T', 'O', 'K', 'S', '\0' };
+
+uint32_t TokenRecord::lexeme() const {
+    return lexemeAndKind & (TOKEN_INDEX_MAX_LEXEMES - 1);
+}
+
+TokenType TokenRecord::kind() const {
+    return static_cast<TokenType>(lexemeAndKind >> 24);
+}
+
+TokenIndexWriter::TokenIndexWriter() : overflow(false), sharedLexemes(false) {
+}
+
+bool TokenIndexWriter::add(const Token& token) {
+    uint32_t index = static_cast<uint32_t>(table.insert(token));
+    if (index >= TOKEN_INDEX_MAX_LEXEMES || token.offset < 0) {
+        overflow = true;
+        return false;
+    }
+    if (index == lexemes.size()) {
+        lexemes.push_back(LexemeRecord{ static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(token.value.size()), static_cast<uint32_t>(token.type) });
+        strings += token.value;
+    }
+    tokens.push_back(TokenRecord{ static_cast<uint32_t>(token.offset), index | (static_cast<uint32_t>(token.type) << 24) });
+    return true;
+}
+
+bool TokenIndexWriter::add(const Token& token, int lexeme) {
+    if (lexeme < 0 || static_cast<uint32_t>(lexeme) >= TOKEN_INDEX_MAX_LEXEMES || token.offset < 0) {
+        overflow = true;
+        return false;
+    }
+    sharedLexemes = true;
+    tokens.push_back(TokenRecord{ static_cast<uint32_t>(token.offset), static_cast<uint32_t>(lexeme) | (static_cast<uint32_t>(token.type) << 24) });
+    return true;
+}
+
+bool TokenIndexWriter::addLexeme(int index, const Token& token) {
+    if (index < 0 || static_cast<uint32_t>(index) >= TOKEN_INDEX_MAX_LEXEMES) {
+        overflow = true;
+        return false;
+    }
+    if (static_cast<size_t>(index) >= lexemes.size()) {
+        lexemes.resize(static_cast<size_t>(index) + 1, LexemeRecord{ 0, 0, static_cast<uint32_t>(TokenType::END_OF_FILE) });
+    }
+    lexemes[index] = LexemeRecord{ static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(token.value.size()), static_cast<uint32_t>(token.type) };
+    strings += token.value;
+    return true;
+}
+
+bool TokenIndexWriter::finish(std::string& out) const {
+    size_t lexemesOffset = sizeof(TokenIndexHeader);
+    size_t tokensOffset = lexemesOffset + lexemes.size() * sizeof(LexemeRecord);
+    size_t stringsOffset = tokensOffset + tokens.size() * sizeof(TokenRecord);
+    size_t total = stringsOffset + strings.size();
+    if (overflow || total > UINT32_MAX || (sharedLexemes && !lexemes.empty())) {
+        return false;
+    }
+    TokenIndexHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TOKEN_INDEX_MAGIC, sizeof(header.magic));
+    header.version = TOKEN_INDEX_VERSION;
+    header.byteOrder = TOKEN_INDEX_BYTE_ORDER;
+    header.headerSize = sizeof(TokenIndexHeader);
+    header.lexemeCount = static_cast<uint32_t>(lexemes.size());
+    header.tokenCount = static_cast<uint32_t>(tokens.size());
+    header.lexemesOffset = static_cast<uint32_t>(lexemesOffset);
+    header.tokensOffset = static_cast<uint32_t>(tokensOffset);
+    header.stringsOffset = static_cast<uint32_t>(stringsOffset);
+    header.stringsSize = static_cast<uint32_t>(strings.size());
+    header.flags = sharedLexemes ? TOKEN_INDEX_SHARED_LEXEMES : 0;
+    out.resize(total);
+    std::memcpy(&out[0], &header, sizeof(header));
+    if (!lexemes.empty()) {
+        std::memcpy(&out[lexemesOffset], lexemes.data(), lexemes.size() * sizeof(LexemeRecord));
+    }
+    if (!tokens.empty()) {
+        std::memcpy(&out[tokensOffset], tokens.data(), tokens.size() * sizeof(TokenRecord));
+    }
+    if (!strings.empty()) {
+        std::memcpy(&out[stringsOffset], strings.data(), strings.size());
+    }
+    return true;
+}
+
+TokenIndex::TokenIndex()
+    : data(nullptr), size(0), header(nullptr), lexemes(nullptr), tokens(nullptr), strings(nullptr), mapping(nullptr), fileHandle(nullptr) {
+}
+
+TokenIndex::~TokenIndex() {
+    close();
+}
+
+bool TokenIndex::fail(const char* message) {
+    close();
+    lastError = message;
+    return false;
+}
+
+void TokenIndex::close() {
+#ifdef _WIN32
+    if (mapping != nullptr) {
+        UnmapViewOfFile(data);
+        CloseHandle(static_cast<HANDLE>(mapping));
+    }
+    if (fileHandle != nullptr) {
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+    }
+#else
+    if (mapping != nullptr) {
+        munmap(mapping, size);
+    }
+#endif
+    mapping = nullptr;
+    fileHandle = nullptr;
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+    lexemes = nullptr;
+    tokens = nullptr;
+    strings = nullptr;
+}
+
+bool TokenIndex::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return fail("cannot open token index");
+    }
+    fileHandle = file;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(TokenIndexHeader))) {
+        return fail("token index is truncated");
+    }
+    HANDLE view = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (view == nullptr) {
+        return fail("cannot map token index");
+    }
+    mapping = view;
+    const char* bytes = static_cast<const char*>(MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0));
+    if (bytes == nullptr) {
+        CloseHandle(view);
+        mapping = nullptr;
+        return fail("cannot map token index");
+    }
+    size_t length = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return fail("cannot open token index");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(TokenIndexHeader))) {
+        ::close(fd);
+        return fail("token index is truncated");
+    }
+    size_t length = static_cast<size_t>(info.st_size);
+    void* view = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return fail("cannot map token index");
+    }
+    mapping = view;
+    const char* bytes = static_cast<const char*>(view);
+#endif
+    data = bytes;
+    size = length;
+    const char* problem = bind(bytes, length);
+    if (problem != nullptr) {
+        return fail(problem);
+    }
+    lastError.clear();
+    return true;
+}
+
+bool TokenIndex::attach(const char* bytes, size_t length) {
+    close();
+    const char* problem = bind(bytes, length);
+    if (problem != nullptr) {
+        return fail(problem);
+    }
+    data = bytes;
+    size = length;
+    lastError.clear();
+    return true;
+}
+
+const char* TokenIndex::bind(const char* bytes, size_t length) {
+    if (length < sizeof(TokenIndexHeader) || reinterpret_cast<uintptr_t>(bytes) % alignof(TokenIndexHeader) != 0) {
+        return "token index is truncated or misaligned";
+    }
+    const TokenIndexHeader* candidate = reinterpret_cast<const TokenIndexHeader*>(bytes);
+    if (std::memcmp(candidate->magic, TOKEN_INDEX_MAGIC, sizeof(candidate->magic)) != 0) {
+        return "not a token index";
+    }
+    if (candidate->byteOrder != TOKEN_INDEX_BYTE_ORDER) {
+        return "token index was written with a different byte order";
+    }
+    if (candidate->version != TOKEN_INDEX_VERSION || candidate->headerSize != sizeof(TokenIndexHeader)) {
+        return "unsupported token index version";
+    }
+    uint64_t lexemesEnd = static_cast<uint64_t>(candidate->lexemesOffset) + static_cast<uint64_t>(candidate->lexemeCount) * sizeof(LexemeRecord);
+    uint64_t tokensEnd = static_cast<uint64_t>(candidate->tokensOffset) + static_cast<uint64_t>(candidate->tokenCount) * sizeof(TokenRecord);
+    uint64_t stringsEnd = static_cast<uint64_t>(candidate->stringsOffset) + candidate->stringsSize;
+    if (candidate->lexemesOffset < sizeof(TokenIndexHeader) || candidate->lexemesOffset % 4 != 0 || candidate->tokensOffset % 4 != 0
+        || lexemesEnd > length || tokensEnd > length || stringsEnd > length) {
+        return "token index sections are out of bounds";
+    }
+    if ((candidate->flags & ~TOKEN_INDEX_SHARED_LEXEMES) != 0 || ((candidate->flags & TOKEN_INDEX_SHARED_LEXEMES) != 0 && candidate->lexemeCount != 0)) {
+        return "unsupported token index flags";
+    }
+    header = candidate;
+    lexemes = reinterpret_cast<const LexemeRecord*>(bytes + candidate->lexemesOffset);
+    tokens = reinterpret_cast<const TokenRecord*>(bytes + candidate->tokensOffset);
+    strings = bytes + candidate->stringsOffset;
+    for (uint32_t i = 0; i < candidate->lexemeCount; i++) {
+        if (static_cast<uint64_t>(lexemes[i].textOffset) + lexemes[i].length > candidate->stringsSize) {
+            return "token index lexeme is out of bounds";
+        }
+    }
+    return nullptr;
+}
+
+bool TokenIndex::verify(const TokenIndex* lexicon) const {
+    if (header == nullptr) {
+        return false;
+    }
+    const TokenIndex* table = this;
+    if (sharedLexemes()) {
+        if (lexicon == nullptr || lexicon->header == nullptr || lexicon->sharedLexemes()) {
+            return false;
+        }
+        table = lexicon;
+    }
+    for (uint32_t i = 0; i < header->tokenCount; i++) {
+        uint32_t index = tokens[i].lexeme();
+        if (index >= table->header->lexemeCount || static_cast<uint32_t>(tokens[i].kind()) != table->lexemes[index].kind) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TokenIndex::sharedLexemes() const {
+    return header != nullptr && (header->flags & TOKEN_INDEX_SHARED_LEXEMES) != 0;
+}
+
+uint32_t TokenIndex::lexemeCount() const {
+    return header ? header->lexemeCount : 0;
+}
+
+uint32_t TokenIndex::tokenCount() const {
+    return header ? header->tokenCount : 0;
+}
+
+const TokenRecord& TokenIndex::token(uint32_t index) const {
+    return tokens[index];
+}
+
+std::string_view TokenIndex::lexeme(uint32_t index) const {
+    return std::string_view(strings + lexemes[index].textOffset, lexemes[index].length);
+}
+
+TokenType TokenIndex::lexemeKind(uint32_t index) const {
+    return static_cast<TokenType>(lexemes[index].kind);
+}
+
+const std::string& TokenIndex::error() const {
+    return lastError;
+}
@@ -0,0 +1,91 @@
+#ifndef TOKENINDEX_H
+#define TOKENINDEX_H
+
+#include "hashtable.h"
+#include "token.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+const uint32_t TOKEN_INDEX_VERSION = 2;
+const uint32_t TOKEN_INDEX_BYTE_ORDER = 0x01020304;
+const uint32_t TOKEN_INDEX_MAX_LEXEMES = 1u << 24;
+const uint32_t TOKEN_INDEX_SHARED_LEXEMES = 1;
+
+struct TokenIndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t headerSize;
+    uint32_t lexemeCount;
+    uint32_t tokenCount;
+    uint32_t lexemesOffset;
+    uint32_t tokensOffset;
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+    uint32_t flags;
+};
+
+struct LexemeRecord {
+    uint32_t textOffset;
+    uint32_t length;
+    uint32_t kind;
+};
+
+struct TokenRecord {
+    uint32_t offset;
+    uint32_t lexemeAndKind;
+    uint32_t lexeme() const;
+    TokenType kind() const;
+};
+
+class TokenIndexWriter {
+private:
+    HashTable table;
+    std::vector<LexemeRecord> lexemes;
+    std::vector<TokenRecord> tokens;
+    std::string strings;
+    bool overflow;
+    bool sharedLexemes;
+public:
+    TokenIndexWriter();
+    bool add(const Token& token);
+    bool add(const Token& token, int lexeme);
+    bool addLexeme(int index, const Token& token);
+    bool finish(std::string& out) const;
+};
+
+class TokenIndex {
+private:
+    const char* data;
+    size_t size;
+    const TokenIndexHeader* header;
+    const LexemeRecord* lexemes;
+    const TokenRecord* tokens;
+    const char* strings;
+    void* mapping;
+    void* fileHandle;
+    std::string lastError;
+    bool fail(const char* message);
+    const char* bind(const char* bytes, size_t length);
+public:
+    TokenIndex();
+    TokenIndex(const TokenIndex&) = delete;
+    TokenIndex& operator=(const TokenIndex&) = delete;
+    ~TokenIndex();
+    bool open(const std::string& path);
+    bool attach(const char* bytes, size_t length);
+    void close();
+    bool verify(const TokenIndex* lexicon = nullptr) const;
+    bool sharedLexemes() const;
+    uint32_t lexemeCount() const;
+    uint32_t tokenCount() const;
+    const TokenRecord& token(uint32_t index) const;
+    std::string_view lexeme(uint32_t index) const;
+    TokenType lexemeKind(uint32_t index) const;
+    const std::string& error() const;
+};
+
+#endif
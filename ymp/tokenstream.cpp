@@ -0,0 +1,114 @@
+#include "tokenstream.h"
+#include "alloctrack.h"
+#include "attributes.h"
+#include <new>
+#include <utility>
+
+// The coroutine frame holds the token being yielded, so it is token storage.
+// Neither half is inlined: GCC would otherwise pair the global delete with
+// this operator new and warn about a mismatch.
+YMP_NOINLINE void* TokenGenerator::promise_type::operator new(size_t size) {
+    AllocCategoryScope allocCategory(AllocCategory::TOKENS);
+    return ::operator new(size);
+}
+
+YMP_NOINLINE void TokenGenerator::promise_type::operator delete(void* pointer) {
+    ::operator delete(pointer);
+}
+
+TokenGenerator TokenGenerator::promise_type::get_return_object() {
+    return TokenGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+}
+
+std::suspend_always TokenGenerator::promise_type::yield_value(const Token& token) noexcept {
+    current = &token;
+    return {};
+}
+
+TokenGenerator::iterator::iterator(std::coroutine_handle<promise_type> h) : handle(h) {
+}
+
+const Token& TokenGenerator::iterator::operator*() const {
+    return *handle.promise().current;
+}
+
+const Token* TokenGenerator::iterator::operator->() const {
+    return handle.promise().current;
+}
+
+TokenGenerator::iterator& TokenGenerator::iterator::operator++() {
+    handle.resume();
+    return *this;
+}
+
+bool TokenGenerator::iterator::operator==(std::default_sentinel_t) const {
+    return !handle || handle.done();
+}
+
+TokenGenerator::TokenGenerator(std::coroutine_handle<promise_type> h) : handle(h) {
+}
+
+TokenGenerator::TokenGenerator(TokenGenerator&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {
+}
+
+TokenGenerator& TokenGenerator::operator=(TokenGenerator&& other) noexcept {
+    if (this != &other) {
+        if (handle) {
+            handle.destroy();
+        }
+        handle = std::exchange(other.handle, nullptr);
+    }
+    return *this;
+}
+
+TokenGenerator::~TokenGenerator() {
+    if (handle) {
+        handle.destroy();
+    }
+}
+
+TokenGenerator::iterator TokenGenerator::begin() {
+    if (handle) {
+        handle.resume();
+    }
+    return iterator(handle);
+}
+
+std::default_sentinel_t TokenGenerator::end() const {
+    return std::default_sentinel;
+}
+
+TokenGenerator lexTokens(Lexer& lexer) {
+    Token token;
+    lexer.readToken(token);
+    while (token.type != TokenType::END_OF_FILE) {
+        co_yield token;
+        lexer.readToken(token);
+    }
+}
+
+TokenStream::TokenStream(Lexer& l) : lexer(l), head(0), count(0) {
+}
+
+void TokenStream::fill(size_t needed) {
+    while (count < needed) {
+        lexer.readToken(buffer[(head + count) % MAX_LOOKAHEAD]);
+        count++;
+    }
+}
+
+void TokenStream::next(Token& out) {
+    if (count == 0) {
+        lexer.readToken(out);
+        return;
+    }
+    std::swap(out, buffer[head]);
+    head = (head + 1) % MAX_LOOKAHEAD;
+    count--;
+}
+
+void TokenStream::advance() {
+    fill(1);
+    head = (head + 1) % MAX_LOOKAHEAD;
+    count--;
+}
@@ -0,0 +1,73 @@
+#ifndef TOKENSTREAM_H
+#define TOKENSTREAM_H
+
+#include "lexer.h"
+#include "token.h"
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+
+class TokenGenerator {
+public:
+    struct promise_type {
+        const Token* current = nullptr;
+        static void* operator new(size_t size);
+        static void operator delete(void* pointer);
+        TokenGenerator get_return_object();
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(const Token& token) noexcept;
+        void return_void() noexcept {}
+        void unhandled_exception() { throw; }
+    };
+
+    class iterator {
+    private:
+        std::coroutine_handle<promise_type> handle;
+    public:
+        iterator(std::coroutine_handle<promise_type> h = nullptr);
+        const Token& operator*() const;
+        const Token* operator->() const;
+        iterator& operator++();
+        bool operator==(std::default_sentinel_t) const;
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle;
+    explicit TokenGenerator(std::coroutine_handle<promise_type> h);
+public:
+    TokenGenerator(TokenGenerator&& other) noexcept;
+    TokenGenerator& operator=(TokenGenerator&& other) noexcept;
+    TokenGenerator(const TokenGenerator&) = delete;
+    TokenGenerator& operator=(const TokenGenerator&) = delete;
+    ~TokenGenerator();
+    iterator begin();
+    std::default_sentinel_t end() const;
+};
+
+TokenGenerator lexTokens(Lexer& lexer);
+
+class TokenStream {
+public:
+    static const size_t MAX_LOOKAHEAD = 4;
+private:
+    Lexer& lexer;
+    Token buffer[MAX_LOOKAHEAD];
+    size_t head;
+    size_t count;
+    void fill(size_t needed);
+public:
+    TokenStream(Lexer& l);
+    TokenStream(const TokenStream&) = delete;
+    TokenStream& operator=(const TokenStream&) = delete;
+    template <size_t K = 0>
+    const Token& peek() {
+        static_assert(K < MAX_LOOKAHEAD, "TokenStream::peek is limited to MAX_LOOKAHEAD tokens");
+        fill(K + 1);
+        return buffer[(head + K) % MAX_LOOKAHEAD];
+    }
+    void next(Token& out);
+    void advance();
+};
+
+#endif
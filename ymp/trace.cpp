@@ -0,0 +1,125 @@
+#include "trace.h"
+#include <atomic>
+#include <cstdio>
+
+Tracer* Tracer::activeTracer = nullptr;
+
+Tracer::Tracer(TraceLevel l) : level(l), origin(std::chrono::steady_clock::now()) {
+}
+
+Tracer* Tracer::active() {
+    return activeTracer;
+}
+
+void Tracer::setActive(Tracer* tracer) {
+    activeTracer = tracer;
+}
+
+int Tracer::currentThreadId() {
+    static std::atomic<int> nextId(1);
+    thread_local int id = nextId++;
+    return id;
+}
+
+bool Tracer::enabled(TraceLevel eventLevel) const {
+    return static_cast<int>(eventLevel) <= static_cast<int>(level);
+}
+
+long long Tracer::now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void Tracer::record(TraceEvent&& event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    events.push_back(std::move(event));
+}
+
+void Tracer::takeEvents(std::vector<TraceEvent>& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    out.clear();
+    out.swap(events);
+}
+
+void Tracer::appendJsonString(OutputBuffer& out, const std::string& text) const {
+    out.put('"');
+    for (char c : text) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out.put('\\');
+            out.put(c);
+        }
+        else if (u < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", u);
+            out.append(escaped);
+        }
+        else {
+            out.put(c);
+        }
+    }
+    out.put('"');
+}
+
+void Tracer::write(OutputBuffer& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (size_t i = 0; i < events.size(); i++) {
+        const TraceEvent& event = events[i];
+        char times[64];
+        std::snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f", event.startNs / 1000.0, event.durationNs / 1000.0);
+        out.append(i == 0 ? "\n{\"name\":" : ",\n{\"name\":");
+        appendJsonString(out, event.name);
+        out.append(",\"cat\":");
+        appendJsonString(out, event.category);
+        out.append(",\"ph\":\"X\",");
+        out.append(times);
+        out.append(",\"pid\":1,\"tid\":");
+        out.appendInt(event.threadId);
+        if (event.argName != nullptr) {
+            out.append(",\"args\":{");
+            appendJsonString(out, event.argName);
+            out.put(':');
+            if (event.argText.empty()) {
+                out.appendInt(event.argValue);
+            }
+            else {
+                appendJsonString(out, event.argText);
+            }
+            out.put('}');
+        }
+        out.put('}');
+    }
+    out.append("\n]}\n");
+    out.flush();
+}
+
+TraceScope::TraceScope(const char* name, const char* category, TraceLevel eventLevel)
+    : TraceScope(name, category, eventLevel, nullptr, 0) {
+}
+
+TraceScope::TraceScope(const char* name, const char* category, TraceLevel eventLevel, const char* argName, long long argValue)
+    : tracer(Tracer::active()) {
+    if (tracer == nullptr || !tracer->enabled(eventLevel)) {
+        tracer = nullptr;
+        return;
+    }
+    event.name = name;
+    event.category = category;
+    event.argName = argName;
+    event.argValue = argValue;
+    event.threadId = Tracer::currentThreadId();
+    event.startNs = tracer->now();
+}
+
+TraceScope::TraceScope(const char* name, const char* category, TraceLevel eventLevel, const char* argName, const std::string& argText)
+    : TraceScope(name, category, eventLevel, argName, 0) {
+    if (tracer != nullptr) {
+        event.argText = argText;
+    }
+}
+
+TraceScope::~TraceScope() {
+    if (tracer == nullptr) return;
+    event.durationNs = tracer->now() - event.startNs;
+    tracer->record(std::move(event));
+}
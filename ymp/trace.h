@@ -0,0 +1,59 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "output.h"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class TraceLevel {
+    PHASES = 1,
+    STATEMENTS = 2
+};
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    long long startNs;
+    long long durationNs;
+    int threadId;
+    const char* argName;
+    long long argValue;
+    std::string argText;
+};
+
+class Tracer {
+private:
+    static Tracer* activeTracer;
+    TraceLevel level;
+    std::chrono::steady_clock::time_point origin;
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    void appendJsonString(OutputBuffer& out, const std::string& text) const;
+public:
+    Tracer(TraceLevel l);
+    static Tracer* active();
+    static void setActive(Tracer* tracer);
+    static int currentThreadId();
+    bool enabled(TraceLevel eventLevel) const;
+    long long now() const;
+    void record(TraceEvent&& event);
+    void takeEvents(std::vector<TraceEvent>& out);
+    void write(OutputBuffer& out);
+};
+
+class TraceScope {
+private:
+    Tracer* tracer;
+    TraceEvent event;
+public:
+    TraceScope(const char* name, const char* category, TraceLevel eventLevel = TraceLevel::PHASES);
+    TraceScope(const char* name, const char* category, TraceLevel eventLevel, const char* argName, long long argValue);
+    TraceScope(const char* name, const char* category, TraceLevel eventLevel, const char* argName, const std::string& argText);
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+    ~TraceScope();
+};
+
+#endif
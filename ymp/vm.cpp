@@ -0,0 +1,266 @@
+#include "vm.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+
+static int wrapAdd(int a, int b) {
+    return static_cast<int>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b));
+}
+
+static int wrapSub(int a, int b) {
+    return static_cast<int>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b));
+}
+
+static long long nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void appendPadded(OutputBuffer& out, long long value, int width) {
+    char digits[24];
+    int length = 0;
+    unsigned long long magnitude = value < 0 ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+    do {
+        digits[length++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        digits[length++] = '-';
+    }
+    for (int i = length; i < width; i++) {
+        out.put(' ');
+    }
+    while (length > 0) {
+        out.put(digits[--length]);
+    }
+}
+
+static void appendShare(OutputBuffer& out, long long part, long long total) {
+    long long permille = total > 0 ? part * 1000 / total : 0;
+    appendPadded(out, permille / 10, 4);
+    out.put('.');
+    out.put(static_cast<char>('0' + permille % 10));
+    out.put('%');
+}
+
+ExecutionProfile::ExecutionProfile() : runs(0), totalNs(0) {
+}
+
+void ExecutionProfile::reset(const BytecodeProgram& program) {
+    runs = 0;
+    totalNs = 0;
+    instructionCounts.assign(program.code.size(), 0);
+    statementCounts.assign(program.statements.size(), 0);
+    statementNs.assign(program.statements.size(), 0);
+}
+
+void ExecutionProfile::report(const BytecodeProgram& program, OutputBuffer& out) const {
+    long long instructions = 0;
+    for (long long count : instructionCounts) {
+        instructions += count;
+    }
+    out.append("=== PROFILE ===\n");
+    out.append("Function: ");
+    out.append(program.name);
+    out.append("\nRuns: ");
+    out.appendInt(runs);
+    out.append("\nInstructions executed: ");
+    out.appendInt(instructions);
+    out.append("\nStatement time: ");
+    out.appendInt(totalNs);
+    out.append(" ns\n");
+
+    std::vector<size_t> order(program.statements.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](size_t x, size_t y) {
+        return statementNs[x] > statementNs[y];
+    });
+    out.append("\nHOT STATEMENTS:\n rank  line  executions     time ns   share  statement\n");
+    for (size_t rank = 0; rank < order.size(); rank++) {
+        size_t s = order[rank];
+        appendPadded(out, static_cast<long long>(rank + 1), 5);
+        appendPadded(out, program.statements[s].line, 6);
+        appendPadded(out, statementCounts[s], 12);
+        appendPadded(out, statementNs[s], 12);
+        out.put(' ');
+        appendShare(out, statementNs[s], totalNs);
+        out.append("  ");
+        appendStatementText(program, program.statements[s], out);
+        out.put('\n');
+    }
+
+    struct LineTotals {
+        long long statements = 0;
+        long long instructions = 0;
+        long long ns = 0;
+    };
+    std::map<int, LineTotals> lines;
+    for (size_t s = 0; s < program.statements.size(); s++) {
+        LineTotals& totals = lines[program.statements[s].line];
+        totals.statements += statementCounts[s];
+        totals.ns += statementNs[s];
+    }
+    for (size_t pc = 0; pc < program.code.size(); pc++) {
+        lines[program.code[pc].line].instructions += instructionCounts[pc];
+    }
+    out.append("\nSOURCE LINES:\n line  executions  instructions     time ns\n");
+    for (const auto& entry : lines) {
+        appendPadded(out, entry.first, 5);
+        appendPadded(out, entry.second.statements, 12);
+        appendPadded(out, entry.second.instructions, 14);
+        appendPadded(out, entry.second.ns, 12);
+        out.put('\n');
+    }
+
+    out.append("\nINSTRUCTIONS:\n   pc  line       count  instruction\n");
+    for (size_t pc = 0; pc < program.code.size(); pc++) {
+        const Instruction& instr = program.code[pc];
+        appendPadded(out, static_cast<long long>(pc), 5);
+        appendPadded(out, instr.line, 6);
+        appendPadded(out, instructionCounts[pc], 12);
+        out.append("  ");
+        appendInstruction(program, instr, out);
+        out.put('\n');
+    }
+}
+
+VirtualMachine::VirtualMachine(const BytecodeProgram& p)
+    : program(p), profile(nullptr), returned(false), intResult(0) {
+}
+
+void VirtualMachine::setProfile(ExecutionProfile* p) {
+    profile = p;
+}
+
+void VirtualMachine::run() {
+    intSlots.assign(program.variables.size(), 0);
+    stringSlots.assign(program.variables.size(), std::string());
+    intStack.clear();
+    stringStack.clear();
+    returned = false;
+    if (profile) {
+        executeProfiled();
+    }
+    else {
+        execute<false>(0, program.code.size());
+    }
+}
+
+void VirtualMachine::executeProfiled() {
+    profile->runs++;
+    for (size_t s = 0; s < program.statements.size() && !returned; s++) {
+        const BytecodeStatement& statement = program.statements[s];
+        long long start = nowNs();
+        execute<true>(statement.first, statement.last);
+        long long elapsed = nowNs() - start;
+        profile->statementCounts[s]++;
+        profile->statementNs[s] += elapsed;
+        profile->totalNs += elapsed;
+    }
+}
+
+// The profiled instantiation counts each instruction as it runs; the plain one
+// compiles to the same loop as before.
+template <bool Profiled>
+void VirtualMachine::execute(size_t first, size_t last) {
+    const Instruction* code = program.code.data();
+    for (size_t pc = first; pc < last; pc++) {
+        const Instruction& instr = code[pc];
+        if constexpr (Profiled) {
+            profile->instructionCounts[pc]++;
+        }
+        switch (instr.op) {
+        case OpCode::PUSH_INT:
+            intStack.push_back(instr.operand);
+            break;
+        case OpCode::PUSH_STR:
+            stringStack.push_back(program.strings[instr.operand]);
+            break;
+        case OpCode::LOAD_INT:
+            intStack.push_back(intSlots[instr.operand]);
+            break;
+        case OpCode::LOAD_STR:
+            stringStack.push_back(stringSlots[instr.operand]);
+            break;
+        case OpCode::STORE_INT:
+            intSlots[instr.operand] = intStack.back();
+            intStack.pop_back();
+            break;
+        case OpCode::STORE_STR:
+            stringSlots[instr.operand].swap(stringStack.back());
+            stringStack.pop_back();
+            break;
+        case OpCode::ADD: {
+            int right = intStack.back();
+            intStack.pop_back();
+            intStack.back() = wrapAdd(intStack.back(), right);
+            break;
+        }
+        case OpCode::SUB: {
+            int right = intStack.back();
+            intStack.pop_back();
+            intStack.back() = wrapSub(intStack.back(), right);
+            break;
+        }
+        case OpCode::CONCAT: {
+            std::string& left = stringStack[stringStack.size() - 2];
+            left += stringStack.back();
+            stringStack.pop_back();
+            break;
+        }
+        case OpCode::STORE_CONST_INT:
+            intSlots[instr.operand] = instr.extra;
+            break;
+        case OpCode::STORE_CONST_STR:
+            stringSlots[instr.operand] = program.strings[instr.extra];
+            break;
+        case OpCode::STORE_KEEP_INT:
+            intSlots[instr.operand] = intStack.back();
+            break;
+        case OpCode::STORE_KEEP_STR:
+            stringSlots[instr.operand] = stringStack.back();
+            break;
+        case OpCode::ADD_VARS:
+            intStack.push_back(wrapAdd(intSlots[instr.operand], intSlots[instr.extra]));
+            break;
+        case OpCode::CONCAT_N: {
+            size_t base = stringStack.size() - static_cast<size_t>(instr.operand);
+            size_t length = 0;
+            for (size_t i = base; i < stringStack.size(); i++) {
+                length += stringStack[i].size();
+            }
+            std::string& left = stringStack[base];
+            left.reserve(length);
+            for (size_t i = base + 1; i < stringStack.size(); i++) {
+                left += stringStack[i];
+            }
+            stringStack.resize(base + 1);
+            break;
+        }
+        case OpCode::RETURN_INT:
+            intResult = intStack.back();
+            intStack.pop_back();
+            returned = true;
+            return;
+        case OpCode::RETURN_STR:
+            stringResult.swap(stringStack.back());
+            stringStack.pop_back();
+            returned = true;
+            return;
+        }
+    }
+}
+
+bool VirtualMachine::hasResult() const {
+    return returned;
+}
+
+int VirtualMachine::getIntResult() const {
+    return intResult;
+}
+
+const std::string& VirtualMachine::getStringResult() const {
+    return stringResult;
+}
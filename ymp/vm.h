@@ -0,0 +1,45 @@
+#ifndef VM_H
+#define VM_H
+
+#include "bytecode.h"
+#include "output.h"
+#include <string>
+#include <vector>
+
+struct ExecutionProfile {
+    long long runs;
+    long long totalNs;
+    std::vector<long long> instructionCounts;
+    std::vector<long long> statementCounts;
+    std::vector<long long> statementNs;
+    ExecutionProfile();
+    void reset(const BytecodeProgram& program);
+    void report(const BytecodeProgram& program, OutputBuffer& out) const;
+};
+
+class VirtualMachine {
+private:
+    const BytecodeProgram& program;
+    std::vector<int> intSlots;
+    std::vector<std::string> stringSlots;
+    std::vector<int> intStack;
+    std::vector<std::string> stringStack;
+    ExecutionProfile* profile;
+    bool returned;
+    int intResult;
+    std::string stringResult;
+    template <bool Profiled>
+    void execute(size_t first, size_t last);
+    void executeProfiled();
+public:
+    VirtualMachine(const BytecodeProgram& p);
+    VirtualMachine(const VirtualMachine&) = delete;
+    VirtualMachine& operator=(const VirtualMachine&) = delete;
+    void setProfile(ExecutionProfile* p);
+    void run();
+    bool hasResult() const;
+    int getIntResult() const;
+    const std::string& getStringResult() const;
+};
+
+#endif